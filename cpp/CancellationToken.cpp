@@ -0,0 +1,45 @@
+#include "CancellationToken.h"
+
+CancellationToken::CancellationToken(double timeoutMs)
+    : reason(NOT_CANCELLED), timeoutMs(timeoutMs), hasDeadline(false) {}
+
+void CancellationToken::cancel() {
+  int expected = NOT_CANCELLED;
+  reason.compare_exchange_strong(expected, CANCEL_REQUESTED);
+}
+
+void CancellationToken::start() {
+  if (timeoutMs > 0) {
+    hasDeadline = true;
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::microseconds((long long)(timeoutMs * 1000));
+  }
+}
+
+CancellationReason CancellationToken::check() {
+  int current = reason.load();
+  if (current == NOT_CANCELLED && hasDeadline &&
+      std::chrono::steady_clock::now() >= deadline) {
+    reason.compare_exchange_strong(current, CANCEL_TIMEOUT);
+  }
+  return (CancellationReason)reason.load();
+}
+
+static int cancellationProgressHandler(void *data) {
+  CancellationToken *token = static_cast<CancellationToken *>(data);
+  // A non-zero result interrupts the running statement
+  return token->check() != NOT_CANCELLED;
+}
+
+ScopedCancellationHandler::ScopedCancellationHandler(sqlite3 *db,
+                                                     CancellationToken *token)
+    : db(db) {
+  if (token != nullptr) {
+    sqlite3_progress_handler(db, CANCELLATION_CHECK_INTERVAL,
+                             cancellationProgressHandler, token);
+  }
+}
+
+ScopedCancellationHandler::~ScopedCancellationHandler() {
+  sqlite3_progress_handler(db, 0, NULL, NULL);
+}
@@ -0,0 +1,74 @@
+#include "sqlite3.h"
+#include <atomic>
+#include <chrono>
+
+#ifndef CancellationToken_h
+#define CancellationToken_h
+
+// Number of virtual machine instructions between cancellation checks
+#define CANCELLATION_CHECK_INTERVAL 1000
+
+enum CancellationReason {
+  NOT_CANCELLED,
+  // cancel() was called
+  CANCEL_REQUESTED,
+  // The deadline passed while the query was running
+  CANCEL_TIMEOUT,
+};
+
+/**
+ * Cancellation state of a single query execution.
+ *
+ * cancel() can be called from any thread. The worker thread polls the token
+ * through a SQLite progress handler while the query is running, which makes
+ * the running statement fail with SQLITE_INTERRUPT.
+ */
+class CancellationToken {
+private:
+  std::atomic<int> reason;
+  double timeoutMs;
+  // Only accessed by the worker thread
+  std::chrono::steady_clock::time_point deadline;
+  bool hasDeadline;
+
+public:
+  /**
+   * A timeout of zero or less disables the deadline
+   */
+  CancellationToken(double timeoutMs);
+
+  void cancel();
+
+  /**
+   * Starts the deadline, called once the query starts running
+   */
+  void start();
+
+  /**
+   * Returns the reason if the query should stop, checking the deadline
+   */
+  CancellationReason check();
+
+  /**
+   * Returns the reason the query was stopped for, without checking the
+   * deadline
+   */
+  CancellationReason cancelled() const {
+    return (CancellationReason)reason.load();
+  }
+};
+
+/**
+ * Installs a progress handler which polls the token on the connection for
+ * the lifetime of this object
+ */
+class ScopedCancellationHandler {
+private:
+  sqlite3 *db;
+
+public:
+  ScopedCancellationHandler(sqlite3 *db, CancellationToken *token);
+  ~ScopedCancellationHandler();
+};
+
+#endif
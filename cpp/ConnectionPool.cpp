@@ -3,65 +3,78 @@
 #include "sqlite3.h"
 #include "sqliteBridge.h"
 #include "sqliteExecute.h"
+#include <algorithm>
 
 ConnectionPool::ConnectionPool(std::string dbName, std::string docPath,
-                               unsigned int numReadConnections)
-    : dbName(dbName), maxReads(numReadConnections),
+                               unsigned int numReadConnections,
+                               size_t statementCacheSize,
+                               double readIdleTimeoutMs)
+    : maxReads(numReadConnections), dbName(dbName), docPath(docPath),
+      statementCacheSize(statementCacheSize),
       writeConnection(dbName, docPath,
                       SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
-                          SQLITE_OPEN_FULLMUTEX),
+                          SQLITE_OPEN_FULLMUTEX,
+                      statementCacheSize),
       commitPayload(
           {.dbName = &this->dbName, .event = TransactionEvent::COMMIT}),
       rollbackPayload({
           .dbName = &this->dbName,
           .event = TransactionEvent::ROLLBACK,
-      }) {
+      }),
+      readIdleTimeoutMs(readIdleTimeoutMs), isReaperRunning(false) {
 
   onContextCallback = nullptr;
   isConcurrencyEnabled = maxReads > 0;
   isClosed = false;
-
-  readConnections = new ConnectionState *[maxReads];
-  // Open the read connections
-  for (int i = 0; i < maxReads; i++) {
-    readConnections[i] = new ConnectionState(
-        dbName, docPath, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX);
-  }
 };
 
 ConnectionPool::~ConnectionPool() {
-  for (int i = 0; i < maxReads; i++) {
-    delete readConnections[i];
+  if (!isClosed) {
+    closeAll();
   }
-  delete readConnections;
 }
 
-void ConnectionPool::readLock(ConnectionLockId contextId) {
+void ConnectionPool::readLock(ConnectionLockId contextId,
+                              LockPriority priority) {
   // Maintain compatibility if no concurrent read connections are present
   if (false == isConcurrencyEnabled) {
-    return writeLock(contextId);
+    return writeLock(contextId, priority);
   }
 
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
   // Check if there are any available read connections
-  if (readQueue.size() > 0) {
+  if (!readQueue.empty()) {
     // There are already items queued
-    readQueue.push_back(contextId);
+    readQueue.push(contextId, priority);
   } else {
     // Check if there are open slots
-    for (int i = 0; i < maxReads; i++) {
-      if (readConnections[i]->isEmptyLock()) {
+    for (auto readConnection : readConnections) {
+      if (readConnection->isEmptyLock()) {
         // There is an open slot
-        activateContext(*readConnections[i], contextId);
+        activateContext(*readConnection, contextId);
+        return;
+      }
+    }
+
+    if (readConnections.size() < (size_t)maxReads) {
+      try {
+        activateContext(*openReadConnection(), contextId);
         return;
+      } catch (const std::exception &) {
+        if (readConnections.empty()) {
+          throw;
+        }
+        // Wait for one of the open connections instead
       }
     }
 
     // If we made it here, there were no open slots, need to queue
-    readQueue.push_back(contextId);
+    readQueue.push(contextId, priority);
   }
 }
 
-void ConnectionPool::writeLock(ConnectionLockId contextId) {
+void ConnectionPool::writeLock(ConnectionLockId contextId,
+                               LockPriority priority) {
   // Check if there are any available read connections
   if (writeConnection.isEmptyLock()) {
     activateContext(writeConnection, contextId);
@@ -69,20 +82,21 @@ void ConnectionPool::writeLock(ConnectionLockId contextId) {
   }
 
   // If we made it here, there were no open slots, need to queue
-  writeQueue.push_back(contextId);
+  writeQueue.push(contextId, priority);
 }
 
 SQLiteOPResult
 ConnectionPool::queueInContext(ConnectionLockId contextId,
-                               std::function<void(sqlite3 *)> task) {
+                               std::function<void(ConnectionState *)> task) {
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
   ConnectionState *state = nullptr;
   if (writeConnection.matchesLock(contextId)) {
     state = &writeConnection;
   } else {
     // Check if it's a read connection
-    for (int i = 0; i < maxReads; i++) {
-      if (readConnections[i]->matchesLock(contextId)) {
-        state = readConnections[i];
+    for (auto readConnection : readConnections) {
+      if (readConnection->matchesLock(contextId)) {
+        state = readConnection;
         break;
       }
     }
@@ -142,26 +156,29 @@ void ConnectionPool::setTransactionFinalizerHandler(
 }
 
 void ConnectionPool::closeContext(ConnectionLockId contextId) {
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
   if (writeConnection.matchesLock(contextId)) {
-    if (writeQueue.size() > 0) {
+    writeConnection.releaseCursors();
+    if (!writeQueue.empty()) {
       // There are items in the queue, activate the next one
-      activateContext(writeConnection, writeQueue[0]);
-      writeQueue.erase(writeQueue.begin());
+      activateContext(writeConnection, writeQueue.pop());
     } else {
       // No items in the queue, clear the context
       writeConnection.clearLock();
     }
   } else {
     // Check if it's a read connection
-    for (int i = 0; i < maxReads; i++) {
-      if (readConnections[i]->matchesLock(contextId)) {
-        if (readQueue.size() > 0) {
+    for (auto readConnection : readConnections) {
+      if (readConnection->matchesLock(contextId)) {
+        readConnection->releaseCursors();
+        if (!readQueue.empty()) {
           // There are items in the queue, activate the next one
-          activateContext(*readConnections[i], readQueue[0]);
-          readQueue.erase(readQueue.begin());
+          activateContext(*readConnection, readQueue.pop());
         } else {
           // No items in the queue, clear the context
-          readConnections[i]->clearLock();
+          readConnection->clearLock();
+          // The reaper waits for the idle timeout of this connection
+          reaperCondition.notify_all();
         }
         return;
       }
@@ -170,7 +187,16 @@ void ConnectionPool::closeContext(ConnectionLockId contextId) {
 }
 
 void ConnectionPool::closeAll() {
-  isClosed = true;
+  {
+    std::lock_guard<std::recursive_mutex> g(poolMutex);
+    isClosed = true;
+    reaperCondition.notify_all();
+  }
+  if (reaperThread.joinable()) {
+    reaperThread.join();
+  }
+
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
   // Stop any callbacks
   sqlite3_commit_hook(writeConnection.connection,
                       NULL, NULL);
@@ -179,18 +205,21 @@ void ConnectionPool::closeAll() {
   sqlite3_update_hook(writeConnection.connection, 
                         NULL, NULL);
   writeConnection.close();
-  for (int i = 0; i < maxReads; i++) {
-    readConnections[i]->close();
+  for (auto readConnection : readConnections) {
+    readConnection->close();
+    delete readConnection;
   }
+  readConnections.clear();
 }
 
 std::future<void> ConnectionPool::refreshSchema() {
+    std::lock_guard<std::recursive_mutex> g(poolMutex);
     std::vector<std::future<void>> futures;
 
     futures.push_back(writeConnection.refreshSchema());
 
-    for (unsigned int i = 0; i < maxReads; i++) {
-        futures.push_back(readConnections[i]->refreshSchema());
+    for (auto readConnection : readConnections) {
+        futures.push_back(readConnection->refreshSchema());
     }
 
     return std::async(std::launch::async, [futures = std::move(futures)]() mutable {
@@ -208,8 +237,14 @@ SQLiteOPResult ConnectionPool::attachDatabase(std::string const dbFileName,
    * There is no need to check if mainDBName is opened because
    * sqliteExecuteLiteral will do that.
    * */
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
   string dbPath = get_db_path(dbFileName, docPath);
-  string statement = "ATTACH DATABASE '" + dbPath + "' AS " + alias;
+  // The path is a string literal and the alias a quoted identifier, so that
+  // neither can end the statement
+  char *sql = sqlite3_mprintf("ATTACH DATABASE %Q AS \"%w\"", dbPath.c_str(),
+                              alias.c_str());
+  string statement = sql;
+  sqlite3_free(sql);
 
   auto dbConnections = getAllConnections();
 
@@ -224,6 +259,7 @@ SQLiteOPResult ConnectionPool::attachDatabase(std::string const dbFileName,
   }
 
   for (auto &connectionState : dbConnections) {
+    connectionState->statementCache.clear();
     SequelLiteralUpdateResult result =
         sqliteExecuteLiteralWithDB(connectionState->connection, statement);
     if (result.type == SQLiteError) {
@@ -237,6 +273,8 @@ SQLiteOPResult ConnectionPool::attachDatabase(std::string const dbFileName,
     }
   }
 
+  // Read connections opened later attach the database when they are opened
+  attachments.emplace_back(alias, statement);
   return SQLiteOPResult{
       .type = SQLiteOk,
   };
@@ -247,7 +285,10 @@ SQLiteOPResult ConnectionPool::detachDatabase(std::string const alias) {
    * There is no need to check if mainDBName is opened because
    * sqliteExecuteLiteral will do that.
    * */
-  string statement = "DETACH DATABASE " + alias;
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
+  char *sql = sqlite3_mprintf("DETACH DATABASE \"%w\"", alias.c_str());
+  string statement = sql;
+  sqlite3_free(sql);
   auto dbConnections = getAllConnections();
 
   for (auto &connectionState : dbConnections) {
@@ -261,6 +302,8 @@ SQLiteOPResult ConnectionPool::detachDatabase(std::string const alias) {
   }
 
   for (auto &connectionState : dbConnections) {
+    // Cached statements might reference the detached database
+    connectionState->statementCache.clear();
     SequelLiteralUpdateResult result =
         sqliteExecuteLiteralWithDB(connectionState->connection, statement);
     if (result.type == SQLiteError) {
@@ -271,22 +314,118 @@ SQLiteOPResult ConnectionPool::detachDatabase(std::string const alias) {
       };
     }
   }
+
+  attachments.erase(
+      std::remove_if(attachments.begin(), attachments.end(),
+                     [&](auto const &attachment) {
+                       return attachment.first == alias;
+                     }),
+      attachments.end());
   return SQLiteOPResult{
       .type = SQLiteOk,
   };
 }
 
+StatementCacheStats ConnectionPool::getStatementCacheStats() {
+  std::lock_guard<std::recursive_mutex> g(poolMutex);
+  StatementCacheStats result = {};
+  for (auto &connectionState : getAllConnections()) {
+    auto stats = connectionState->statementCache.stats();
+    result.hits += stats.hits;
+    result.misses += stats.misses;
+    result.size += stats.size;
+    result.capacity += stats.capacity;
+  }
+  return result;
+}
+
 // ===================== Private ===============
 
 std::vector<ConnectionState *> ConnectionPool::getAllConnections() {
   std::vector<ConnectionState *> result;
   result.push_back(&writeConnection);
-  for (int i = 0; i < maxReads; i++) {
-    result.push_back(readConnections[i]);
+  for (auto readConnection : readConnections) {
+    result.push_back(readConnection);
   }
   return result;
 }
 
+ConnectionState *ConnectionPool::openReadConnection() {
+  auto state = new ConnectionState(
+      dbName, docPath, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX,
+      statementCacheSize);
+
+  for (auto &attachment : attachments) {
+    SequelLiteralUpdateResult result =
+        sqliteExecuteLiteralWithDB(state->connection, attachment.second);
+    if (result.type == SQLiteError) {
+      delete state;
+      throw std::runtime_error(dbName +
+                               " was unable to attach another database: " +
+                               string(result.message));
+    }
+  }
+  readConnections.push_back(state);
+
+  if (readIdleTimeoutMs > 0 && !isReaperRunning) {
+    if (reaperThread.joinable()) {
+      // The previous reaper stopped once all read connections were closed
+      reaperThread.join();
+    }
+    isReaperRunning = true;
+    reaperThread = std::thread(&ConnectionPool::reapIdleReadConnections, this);
+  }
+  return state;
+}
+
+void ConnectionPool::reapIdleReadConnections() {
+  auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double, std::milli>(readIdleTimeoutMs));
+
+  std::unique_lock<std::recursive_mutex> g(poolMutex);
+  while (!isClosed && !readConnections.empty()) {
+    auto now = std::chrono::steady_clock::now();
+    auto nextCheck = std::chrono::steady_clock::time_point::max();
+    std::vector<ConnectionState *> idleConnections;
+    for (auto it = readConnections.begin(); it != readConnections.end();) {
+      ConnectionState *state = *it;
+      if (state->isEmptyLock()) {
+        auto closeAt = state->idleSince + timeout;
+        if (closeAt <= now) {
+          idleConnections.push_back(state);
+          it = readConnections.erase(it);
+          continue;
+        }
+        nextCheck = std::min(nextCheck, closeAt);
+      }
+      it++;
+    }
+
+    if (!idleConnections.empty()) {
+      // Closing joins the worker thread of a connection, which should not
+      // block lock requests on the pool
+      g.unlock();
+      for (auto state : idleConnections) {
+        state->close();
+        delete state;
+      }
+      g.lock();
+      continue;
+    }
+
+    if (readConnections.empty()) {
+      break;
+    }
+    if (nextCheck == std::chrono::steady_clock::time_point::max()) {
+      // All read connections are locked, closeContext wakes the reaper
+      reaperCondition.wait(g);
+    } else {
+      reaperCondition.wait_until(g, nextCheck);
+    }
+  }
+  isReaperRunning = false;
+}
+
 void ConnectionPool::activateContext(ConnectionState &state,
                                      ConnectionLockId contextId) {
   state.activateLock(contextId);
@@ -1,7 +1,12 @@
 #include "ConnectionState.h"
 #include "JSIHelper.h"
+#include "LockQueue.h"
 #include "sqlite3.h"
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <future>
 
@@ -15,12 +20,20 @@ struct TransactionCallbackPayload {
   TransactionEvent event;
 };
 
-// The number of concurrent read connections to the database.
+// Read connections which have not been locked for this long are closed
+#define DEFAULT_READ_IDLE_TIMEOUT_MS 30000
+
 /**
  * Concurrent connection pool class.
  *
- * This allows for multiple (currently READ_CONNECTIONS) read connections and a
- * single write connection to operate concurrently.
+ * This allows for multiple (up to maxReads) read connections and a single
+ * write connection to operate concurrently.
+ *
+ * Read connections are opened on demand when a read lock is requested while
+ * all open read connections are locked. Read connections which stay unlocked
+ * for longer than the idle timeout are closed again by a reaper thread, which
+ * only runs while read connections are open. Databases attached to the pool
+ * are attached to read connections as they are opened.
  *
  * The SQLite database connections are opened in WAL mode, allowing for
  * concurrent reads and writes.
@@ -31,7 +44,10 @@ struct TransactionCallbackPayload {
  *
  * Operations requesting locks here are synchronous and should be executed on a
  * single thread, however once a lock is active the connections can be used in a
- * thread pool for async statement executions.
+ * thread pool for async statement executions. A read lock request which opens a
+ * new read connection blocks the calling thread, usually the JS thread, while
+ * the connection is opened and databases are attached to it. Set an idle
+ * timeout of 0 to keep read connections open and pay this cost only once.
  *
  * Synchronization, callback queueing and executions are managed by the
  * JavaScript portion of the library.
@@ -44,9 +60,10 @@ struct TransactionCallbackPayload {
  * ....... bridge is informed from the Connection pool that the requested
  * ....... context lock ID is now active and SQL requests can be made with the
  * ....... context ID (on the relevant connection).
- * ------> If no connections are available, the context ID is added to a FIFO
- * ....... queue. Once other requests are completed the JavaScript bridge is
- * ....... informed that the requested context lock ID is now active.
+ * ------> If no connections are available, the context ID is added to a
+ * ....... queue ordered by the priority of the request. Once other requests
+ * ....... are completed the JavaScript bridge is informed that the requested
+ * ....... context lock ID is now active.
  *
  *  + Any SQL requests are triggered (at the correct time) from the JavaScript
  * callback. Those requests are synchronized by returning JSI promises over the
@@ -59,11 +76,15 @@ class ConnectionPool {
 private:
   int maxReads;
   std::string dbName;
-  ConnectionState **readConnections;
+  std::string docPath;
+  size_t statementCacheSize;
+  std::vector<ConnectionState *> readConnections;
   ConnectionState writeConnection;
+  // Pairs of alias and ATTACH statement of attached databases
+  std::vector<std::pair<std::string, std::string>> attachments;
 
-  std::vector<ConnectionLockId> readQueue;
-  std::vector<ConnectionLockId> writeQueue;
+  LockQueue readQueue;
+  LockQueue writeQueue;
 
   // Cached constant payloads for c style commit/rollback callbacks
   const TransactionCallbackPayload commitPayload;
@@ -74,11 +95,20 @@ private:
 
   bool isConcurrencyEnabled;
 
+  // Zero keeps read connections open until the pool is closed
+  double readIdleTimeoutMs;
+  // Guards the read connections, which are closed by the reaper thread
+  std::recursive_mutex poolMutex;
+  std::condition_variable_any reaperCondition;
+  std::thread reaperThread;
+  bool isReaperRunning;
+
 public:
   bool isClosed;
 
   ConnectionPool(std::string dbName, std::string docPath,
-                 unsigned int numReadConnections);
+                 unsigned int numReadConnections, size_t statementCacheSize,
+                 double readIdleTimeoutMs = DEFAULT_READ_IDLE_TIMEOUT_MS);
   ~ConnectionPool();
 
   friend int onCommitIntermediate(ConnectionPool *pool);
@@ -87,18 +117,20 @@ public:
    * Add a task to the read queue. If there are no available connections,
    * the task will be queued.
    */
-  void readLock(ConnectionLockId contextId);
+  void readLock(ConnectionLockId contextId,
+                LockPriority priority = NormalPriority);
 
   /**
    * Add a task to the write queue.
    */
-  void writeLock(ConnectionLockId contextId);
+  void writeLock(ConnectionLockId contextId,
+                 LockPriority priority = NormalPriority);
 
   /**
    * Queue in context
    */
   SQLiteOPResult queueInContext(ConnectionLockId contextId,
-                                std::function<void(sqlite3 *)> task);
+                                std::function<void(ConnectionState *)> task);
 
   /**
    * Callback function when a new context is available for use
@@ -143,9 +175,26 @@ public:
 
   SQLiteOPResult detachDatabase(std::string const alias);
 
+  /**
+   * Aggregated prepared statement cache counters of all open connections
+   */
+  StatementCacheStats getStatementCacheStats();
+
 private:
   std::vector<ConnectionState *> getAllConnections();
 
+  /**
+   * Opens a read connection and attaches the attached databases to it. Throws
+   * if the connection could not be opened.
+   */
+  ConnectionState *openReadConnection();
+
+  /**
+   * Closes read connections which have been idle for longer than the idle
+   * timeout. Runs on the reaper thread until no read connections are open.
+   */
+  void reapIdleReadConnections();
+
   void activateContext(ConnectionState &state, ConnectionLockId contextId);
 
   SQLiteOPResult genericSqliteOpenDb(string const dbName, string const docPath,
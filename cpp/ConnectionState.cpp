@@ -8,9 +8,13 @@ SQLiteOPResult genericSqliteOpenDb(string const dbName, string const docPath,
                                    sqlite3 **db, int sqlOpenFlags);
 
 ConnectionState::ConnectionState(const std::string dbName,
-                                 const std::string docPath, int SQLFlags) {
+                                 const std::string docPath, int SQLFlags,
+                                 size_t statementCacheSize)
+    : statementCache(statementCacheSize) {
   auto result = genericSqliteOpenDb(dbName, docPath, &connection, SQLFlags);
    if (result.type != SQLiteOk) {
+    // The handle is allocated even if opening or configuring it fails
+    sqlite3_close_v2(connection);
     throw std::runtime_error("Failed to open SQLite database: " + result.errorMessage);
   }
    thread = std::thread(&ConnectionState::doWork, this);
@@ -26,6 +30,7 @@ ConnectionState::~ConnectionState() {
 void ConnectionState::clearLock() {
   waitFinished();
   _currentLockId = EMPTY_LOCK_ID;
+  idleSince = std::chrono::steady_clock::now();
 }
 
 void ConnectionState::activateLock(const ConnectionLockId &lockId) {
@@ -42,9 +47,12 @@ std::future<void> ConnectionState::refreshSchema() {
     auto promise = std::make_shared<std::promise<void>>();
     auto future = promise->get_future();
 
-    queueWork([promise](sqlite3* db) {
+    queueWork([promise](ConnectionState* state) {
         try {
-            int rc = sqlite3_exec(db, "PRAGMA table_info('sqlite_master')", nullptr, nullptr, nullptr);
+            // Cached statements would be re-prepared by SQLite on first use,
+            // flush them to release any references to the old schema.
+            state->statementCache.clear();
+            int rc = sqlite3_exec(state->connection, "PRAGMA table_info('sqlite_master')", nullptr, nullptr, nullptr);
             if (rc != SQLITE_OK) {
                 throw std::runtime_error("Failed to refresh schema");
             }
@@ -79,11 +87,15 @@ void ConnectionState::close() {
     thread.join();
   }
 
+  // Cached statements need to be finalized before the connection can close
+  statementCache.clear();
+  finalizeCursors();
+
   // Safely close the SQLite connection
   sqlite3_close_v2(connection);
 }
 
-void ConnectionState::queueWork(std::function<void(sqlite3 *)> task) {
+void ConnectionState::queueWork(std::function<void(ConnectionState *)> task) {
   {
     std::unique_lock<std::mutex> g(workQueueMutex);
     if (isClosed) {
@@ -95,10 +107,62 @@ void ConnectionState::queueWork(std::function<void(sqlite3 *)> task) {
   workQueueConditionVariable.notify_all(); 
 }
 
+int ConnectionState::addCursor(sqlite3_stmt *statement) {
+  std::lock_guard<std::mutex> g(cursorsMutex);
+  int cursorId = nextCursorId++;
+  cursors[cursorId] = statement;
+  return cursorId;
+}
+
+sqlite3_stmt *ConnectionState::getCursor(int cursorId) {
+  std::lock_guard<std::mutex> g(cursorsMutex);
+  auto it = cursors.find(cursorId);
+  return it != cursors.end() ? it->second : nullptr;
+}
+
+void ConnectionState::closeCursor(int cursorId) {
+  sqlite3_stmt *statement = nullptr;
+  {
+    std::lock_guard<std::mutex> g(cursorsMutex);
+    auto it = cursors.find(cursorId);
+    if (it == cursors.end()) {
+      return;
+    }
+    statement = it->second;
+    cursors.erase(it);
+  }
+  sqlite3_finalize(statement);
+}
+
+void ConnectionState::releaseCursors() {
+  {
+    std::lock_guard<std::mutex> g(cursorsMutex);
+    if (cursors.empty()) {
+      return;
+    }
+  }
+
+  if (isClosed) {
+    // Closing the connection finalizes any remaining cursors
+    return;
+  }
+
+  // Pending work of the released context might still use the cursors
+  queueWork([](ConnectionState *state) { state->finalizeCursors(); });
+}
+
+void ConnectionState::finalizeCursors() {
+  std::lock_guard<std::mutex> g(cursorsMutex);
+  for (auto &cursor : cursors) {
+    sqlite3_finalize(cursor.second);
+  }
+  cursors.clear();
+}
+
 void ConnectionState::doWork() {
   // Loop while the queue is not destructing
   while (!threadDone) {
-    std::function<void(sqlite3 *)> task;
+    std::function<void(ConnectionState *)> task;
 
     // Create a scope, so we don't lock the queue for longer than necessary
     {
@@ -119,7 +183,7 @@ void ConnectionState::doWork() {
     }
 
     threadBusy = true;
-    task(connection);
+    task(this);
     threadBusy = false;
     // Need to notify in order for waitFinished to be updated when
     // the queue is empty and not busy
@@ -1,5 +1,7 @@
 #include "JSIHelper.h"
+#include "StatementCache.h"
 #include "sqlite3.h"
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -7,6 +9,7 @@
 #include <thread>
 #include <vector>
 #include <future>
+#include <map>
 
 #ifndef ConnectionState_h
 #define ConnectionState_h
@@ -17,11 +20,14 @@ class ConnectionState {
 public:
   // Only to be used by connection pool under some circumstances
   sqlite3 *connection;
+  // Prepared statements for this connection. Only to be used from queued work
+  // or while the connection is not locked.
+  StatementCache statementCache;
 
 private:
   ConnectionLockId _currentLockId;
   // Queue of requests waiting to be processed
-  std::queue<std::function<void(sqlite3 *)>> workQueue;
+  std::queue<std::function<void(ConnectionState *)>> workQueue;
   // Mutex to protect workQueue
   std::mutex workQueueMutex;
   // Store thread in order to stop it gracefully
@@ -31,12 +37,19 @@ private:
   std::condition_variable_any workQueueConditionVariable;
   std::atomic<bool> threadBusy{false};
   std::atomic<bool> threadDone{false};
+  // Statements of cursors opened in the current lock context
+  std::map<int, sqlite3_stmt *> cursors;
+  // Mutex to protect cursors
+  std::mutex cursorsMutex;
+  int nextCursorId = 1;
 
 public:
   std::atomic<bool> isClosed{false};
+  // Time the lock was last cleared
+  std::chrono::steady_clock::time_point idleSince;
 
   ConnectionState(const std::string dbName, const std::string docPath,
-                  int SQLFlags);
+                  int SQLFlags, size_t statementCacheSize);
   ~ConnectionState();
 
   void clearLock();
@@ -46,11 +59,27 @@ public:
 
   std::future<void> refreshSchema();
   void close();
-  void queueWork(std::function<void(sqlite3 *)> task);
+  void queueWork(std::function<void(ConnectionState *)> task);
+
+  /**
+   * Keeps a statement alive between queued work. Returns the cursor ID.
+   */
+  int addCursor(sqlite3_stmt *statement);
+  sqlite3_stmt *getCursor(int cursorId);
+  /**
+   * Finalizes the statement of a cursor. Only to be used from queued work.
+   */
+  void closeCursor(int cursorId);
+  /**
+   * Queues finalizing all open cursors. Cursors are bound to the lock context
+   * they were opened in, this needs to be called when the context is released.
+   */
+  void releaseCursors();
 
 private:
   void doWork();
   void waitFinished();
+  void finalizeCursors();
 };
 
 #endif
@@ -7,6 +7,12 @@
 
 #include "JSIHelper.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
 #include <utility>
 
 using namespace std;
@@ -14,122 +20,820 @@ using namespace facebook;
 
 QuickValue createNullQuickValue()
 {
-  return QuickValue{
-    .dataType = NULL_VALUE};
+  return QuickValue{};
 }
 
 QuickValue createBooleanQuickValue(bool value)
 {
   return QuickValue{
-    .dataType = BOOLEAN,
-    .booleanValue = int(value)};
+    .value = (long long)value};
 }
 
 QuickValue createTextQuickValue(string value)
 {
   return QuickValue{
-    .dataType = TEXT,
-    .textValue = std::move(value)};
+    .value = std::move(value)};
 }
 
 QuickValue createIntegerQuickValue(int value)
 {
   return QuickValue{
-    .dataType = INTEGER,
-    .doubleOrIntValue = static_cast<double>(value)};
+    .value = (long long)value};
 }
 
 QuickValue createIntegerQuickValue(double value)
 {
   return QuickValue{
-    .dataType = INTEGER,
-    .doubleOrIntValue = value};
+    .value = (long long)value};
 }
 
 QuickValue createInt64QuickValue(long long value)
 {
   return QuickValue{
-    .dataType = INT64,
-    .int64Value = value};
+    .value = value};
 }
 
 QuickValue createDoubleQuickValue(double value)
 {
   return QuickValue{
-    .dataType = DOUBLE,
-    .doubleOrIntValue = value};
+    .value = value};
 }
 
 QuickValue createArrayBufferQuickValueByCopying(const uint8_t *arrayBufferValue, size_t arrayBufferSize)
 {
-  vector<uint8_t> copy(arrayBufferValue, arrayBufferValue + arrayBufferSize);
+  QuickBlob blob{
+    .data = unique_ptr<uint8_t[]>(new uint8_t[arrayBufferSize]),
+    .size = arrayBufferSize};
+  memcpy(blob.data.get(), arrayBufferValue, arrayBufferSize);
 
   return QuickValue{
-    .dataType = ARRAY_BUFFER,
-    .arrayBuffer = copy};
+    .value = std::move(blob)};
+}
+
+QuickDataType QuickValue::dataType() const
+{
+  switch (value.index())
+  {
+  case 1:
+    return INT64;
+  case 2:
+    return DOUBLE;
+  case 3:
+    return TEXT;
+  case 4:
+    return ARRAY_BUFFER;
+  default:
+    return NULL_VALUE;
+  }
 }
 
-void jsiQueryArgumentsToSequelParam(jsi::Runtime &rt, jsi::Value const &params, vector<QuickValue> *target)
+QuickExecuteOptions jsiExecuteOptions(jsi::Runtime &rt, jsi::Value const &options)
+{
+  QuickExecuteOptions result;
+  if (!options.isObject())
+  {
+    return result;
+  }
+
+  jsi::Object object = options.asObject(rt);
+  jsi::Value rowFormat = object.getProperty(rt, "rowFormat");
+  if (rowFormat.isString())
+  {
+    string format = rowFormat.asString(rt).utf8(rt);
+    if (format == "array")
+    {
+      result.rowFormat = ROW_ARRAYS;
+    }
+    else if (format == "lazy")
+    {
+      result.rowFormat = ROW_LAZY;
+    }
+    else if (format == "json")
+    {
+      result.rowFormat = ROW_JSON;
+    }
+  }
+  jsi::Value integerMode = object.getProperty(rt, "integerMode");
+  if (integerMode.isString() && integerMode.asString(rt).utf8(rt) == "bigint")
+  {
+    result.integerFormat = INTEGER_BIGINT;
+  }
+  jsi::Value allResults = object.getProperty(rt, "allResults");
+  result.allResults = allResults.isBool() && allResults.getBool();
+  jsi::Value timeoutMs = object.getProperty(rt, "timeoutMs");
+  if (timeoutMs.isNumber())
+  {
+    result.timeoutMs = timeoutMs.asNumber();
+  }
+  jsi::Value cancellationId = object.getProperty(rt, "cancellationId");
+  if (cancellationId.isString())
+  {
+    result.cancellationId = cancellationId.asString(rt).utf8(rt);
+  }
+  jsi::Value chunkRows = object.getProperty(rt, "chunkRows");
+  if (chunkRows.isNumber() && chunkRows.asNumber() > 0)
+  {
+    result.chunkRows = (size_t)chunkRows.asNumber();
+  }
+  jsi::Value chunkBudgetMs = object.getProperty(rt, "chunkBudgetMs");
+  if (chunkBudgetMs.isNumber())
+  {
+    result.chunkBudgetMs = chunkBudgetMs.asNumber();
+  }
+
+  return result;
+}
+
+QuickValue jsiValueToQuickValue(jsi::Runtime &rt, jsi::Value const &value)
+{
+  if (value.isBool())
+  {
+    return createBooleanQuickValue(value.getBool());
+  }
+  else if (value.isNumber())
+  {
+    double doubleVal = value.asNumber();
+    int intVal = (int)doubleVal;
+    long long longVal = (long long)doubleVal;
+    if (intVal == doubleVal)
+    {
+      return createIntegerQuickValue(intVal);
+    }
+    else if (longVal == doubleVal)
+    {
+      return createInt64QuickValue(longVal);
+    }
+    return createDoubleQuickValue(doubleVal);
+  }
+#ifdef QUICK_SQLITE_JSI_BIGINT
+  else if (value.isBigInt())
+  {
+    jsi::BigInt bigint = value.getBigInt(rt);
+    if (!bigint.isInt64(rt))
+    {
+      throw std::invalid_argument("[react-native-quick-sqlite] BigInt parameter does not fit into a 64 bit integer");
+    }
+    return createInt64QuickValue(bigint.getInt64(rt));
+  }
+#endif
+  else if (value.isString())
+  {
+    return createTextQuickValue(value.asString(rt).utf8(rt));
+  }
+  else if (value.isObject())
+  {
+    auto obj = value.asObject(rt);
+    if (obj.isArrayBuffer(rt))
+    {
+      auto buf = obj.getArrayBuffer(rt);
+      return createArrayBufferQuickValueByCopying(buf.data(rt), buf.size(rt));
+    }
+  }
+  // null, undefined and unsupported objects
+  return createNullQuickValue();
+}
+
+void jsiQueryArgumentsToSequelParam(jsi::Runtime &rt, jsi::Value const &params, QuickParameters *target)
 {
   if (params.isNull() || params.isUndefined())
   {
     return;
   }
 
-  jsi::Array values = params.asObject(rt).asArray(rt);
+  jsi::Object object = params.asObject(rt);
+  if (object.isArrayBuffer(rt) || object.isFunction(rt))
+  {
+    throw std::invalid_argument("[react-native-quick-sqlite] Query parameters must be an array or an object of named parameters");
+  }
+  if (!object.isArray(rt))
+  {
+    // Named parameters, bound by name
+    jsi::Array names = object.getPropertyNames(rt);
+    size_t length = names.length(rt);
+    target->values.reserve(length);
+    target->names.reserve(length);
+    for (size_t ii = 0; ii < length; ii++)
+    {
+      string name = names.getValueAtIndex(rt, ii).asString(rt).utf8(rt);
+      target->values.push_back(jsiValueToQuickValue(rt, object.getProperty(rt, name.c_str())));
+      target->names.push_back(std::move(name));
+    }
+    return;
+  }
+
+  jsi::Array values = object.asArray(rt);
+  size_t length = values.length(rt);
+  target->values.reserve(target->values.size() + length);
+
+  for (size_t ii = 0; ii < length; ii++)
+  {
+    target->values.push_back(jsiValueToQuickValue(rt, values.getValueAtIndex(rt, ii)));
+  }
+}
+
+void QuickColumn::setCellType(QuickDataType type)
+{
+  if (!cellTypes.empty())
+  {
+    cellTypes.push_back(type);
+  } else if (type == NULL_VALUE || type == dataType)
+  {
+    return;
+  } else if (dataType == NULL_VALUE)
+  {
+    dataType = type;
+  } else
+  {
+    // Cells of different types, track the type of every cell from here on.
+    // Types of previous NULL cells are never read, the null bitmap wins.
+    cellTypes.assign(size(), dataType);
+    cellTypes.push_back(type);
+  }
+}
+
+void QuickColumn::appendNull()
+{
+  setCellType(NULL_VALUE);
+  if (!numbers.empty())
+  {
+    numbers.push_back(QuickNumber{.int64Value = 0});
+  }
+  if (!bytes.empty())
+  {
+    bytes.push_back(QuickBytes{.data = nullptr, .size = 0});
+  }
+  nulls.push_back(true);
+}
+
+void QuickColumn::appendInteger(long long value)
+{
+  setCellType(INTEGER);
+  // Lazily start tracking numbers for the previous rows
+  numbers.resize(size());
+  numbers.push_back(QuickNumber{.int64Value = value});
+  if (!bytes.empty())
+  {
+    bytes.push_back(QuickBytes{.data = nullptr, .size = 0});
+  }
+  nulls.push_back(false);
+}
+
+void QuickColumn::appendDouble(double value)
+{
+  setCellType(DOUBLE);
+  numbers.resize(size());
+  numbers.push_back(QuickNumber{.doubleValue = value});
+  if (!bytes.empty())
+  {
+    bytes.push_back(QuickBytes{.data = nullptr, .size = 0});
+  }
+  nulls.push_back(false);
+}
+
+void QuickColumn::appendBytes(QuickDataType type, const uint8_t *data, size_t size)
+{
+  setCellType(type);
+  if (!numbers.empty())
+  {
+    numbers.push_back(QuickNumber{.int64Value = 0});
+  }
+  // Lazily start tracking bytes for the previous rows
+  bytes.resize(this->size(), QuickBytes{.data = nullptr, .size = 0});
+  bytes.push_back(QuickBytes{.data = data, .size = size});
+  nulls.push_back(false);
+}
+
+QuickDataType QuickColumn::typeAt(size_t row) const
+{
+  if (nulls[row])
+  {
+    return NULL_VALUE;
+  }
+  return cellTypes.empty() ? dataType : (QuickDataType)cellTypes[row];
+}
+
+const uint8_t *QuickColumn::bytesAt(size_t row, size_t *size) const
+{
+  *size = bytes[row].size;
+  return bytes[row].data;
+}
+
+jsi::Value createQuickIntegerValue(jsi::Runtime &rt, long long value, QuickIntegerFormat format)
+{
+#ifdef QUICK_SQLITE_JSI_BIGINT
+  if (format == INTEGER_BIGINT)
+  {
+    return jsi::BigInt::fromInt64(rt, value);
+  }
+#endif
+  /**
+   * JS numbers can represent all integers up to 53 bits long, which covers
+   * most integer columns. Larger values lose precision, use the BigInt
+   * integer mode for those.
+   *
+   * See https://github.com/margelo/react-native-quick-sqlite/issues/16
+   * for more context.
+   */
+  return jsi::Value(static_cast<double>(value));
+}
+
+#ifdef QUICK_SQLITE_JSI_MUTABLE_BUFFER
+/**
+ * A BLOB value inside the arena of a result set. The result set is not
+ * modified after it has been read, so the bytes stay valid for as long as the
+ * buffer holds a reference to it. The ArrayBuffer is writable, so each value
+ * may only be exposed once, values which are converted repeatedly are copied.
+ */
+class QuickResultBuffer : public jsi::MutableBuffer
+{
+public:
+  QuickResultBuffer(shared_ptr<QuickResultSet> owner, uint8_t *data, size_t size)
+    : owner(std::move(owner)), bytes(data), length(size) {}
+
+  size_t size() const override { return length; }
+  uint8_t *data() override { return bytes; }
+
+private:
+  shared_ptr<QuickResultSet> owner;
+  uint8_t *bytes;
+  size_t length;
+};
+#endif
+
+jsi::Value createQuickBlobValue(jsi::Runtime &rt, shared_ptr<QuickResultSet> const &owner, const uint8_t *data, size_t size)
+{
+#ifdef QUICK_SQLITE_JSI_MUTABLE_BUFFER
+  if (owner != nullptr)
+  {
+    // Every ArrayBuffer gets its own region of the arena
+    auto buffer = make_shared<QuickResultBuffer>(owner, const_cast<uint8_t *>(data), size);
+    return jsi::ArrayBuffer(rt, std::move(buffer));
+  }
+#endif
+  jsi::Function array_buffer_ctor = rt.global().getPropertyAsFunction(rt, "ArrayBuffer");
+  jsi::Object o = array_buffer_ctor.callAsConstructor(rt, (int) size).getObject(rt);
+  jsi::ArrayBuffer buf = o.getArrayBuffer(rt);
+  // It's a shame we have to copy here: see https://github.com/facebook/hermes/pull/419 and https://github.com/facebook/hermes/issues/564.
+  memcpy(buf.data(rt), data, size);
+  return o;
+}
+
+jsi::Value createQuickColumnValue(jsi::Runtime &rt, shared_ptr<QuickResultSet> const &owner, QuickColumn const &column, size_t row, QuickExecuteOptions const &options)
+{
+  switch (column.typeAt(row))
+  {
+  case TEXT:
+  {
+    size_t size;
+    const uint8_t *text = column.bytesAt(row, &size);
+    // Using the byte length allows strings with NULLs in them like SQLite does
+    return jsi::String::createFromUtf8(rt, text, size);
+  }
+  case INTEGER:
+    return createQuickIntegerValue(rt, column.integerAt(row), options.integerFormat);
+  case DOUBLE:
+    return jsi::Value(column.doubleAt(row));
+  case ARRAY_BUFFER:
+  {
+    size_t size;
+    const uint8_t *blob = column.bytesAt(row, &size);
+    return createQuickBlobValue(rt, owner, blob, size);
+  }
+  default:
+    return jsi::Value(nullptr);
+  }
+}
+
+jsi::Value createQuickColumnMetadata(jsi::Runtime &rt, QuickResultSet const &results)
+{
+  size_t column_count = results.columns.size();
+  auto column_array = jsi::Array(rt, column_count);
+  for (int i = 0; i < column_count; i++) {
+    auto &column = results.columns[i];
+    jsi::Object column_object = jsi::Object(rt);
+    column_object.setProperty(rt, "columnName", jsi::String::createFromUtf8(rt, column.columnName.c_str()));
+    column_object.setProperty(rt, "columnDeclaredType", jsi::String::createFromUtf8(rt, column.columnDeclaredType.c_str()));
+    column_object.setProperty(rt, "columnIndex", jsi::Value(column.columnIndex));
+    column_array.setValueAtIndex(rt, i, move(column_object));
+  }
+  return move(column_array);
+}
+
+QuickResultConverter::QuickResultConverter(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> results, QuickExecuteOptions options)
+  : status(std::move(status)), results(std::move(results)), options(std::move(options)),
+    rows(rt, this->results != nullptr ? this->results->rowCount : 0), nextRow(0), chunks(0)
+{
+  if (this->options.rowFormat == ROW_OBJECTS && this->results != nullptr)
+  {
+    // Create property names once per result set instead of once per cell
+    columnNames.reserve(this->results->columns.size());
+    for (const auto &column : this->results->columns)
+    {
+      columnNames.push_back(jsi::PropNameID::forUtf8(rt, column.columnName));
+    }
+  }
+}
+
+jsi::Value QuickResultConverter::createRow(jsi::Runtime &rt, size_t row)
+{
+  auto &columns = results->columns;
+  if (options.rowFormat == ROW_ARRAYS)
+  {
+    // Rows only need index writes, there are no property names to look up
+    auto rowArray = jsi::Array(rt, columns.size());
+    for (size_t j = 0; j < columns.size(); j++)
+    {
+      rowArray.setValueAtIndex(rt, j, createQuickColumnValue(rt, results, columns[j], row, options));
+    }
+    return move(rowArray);
+  }
+
+  jsi::Object rowObject = jsi::Object(rt);
+  // Iterate over columns to maintain column order
+  for (size_t j = 0; j < columnNames.size(); j++)
+  {
+    rowObject.setProperty(rt, columnNames[j], createQuickColumnValue(rt, results, columns[j], row, options));
+  }
+  return move(rowObject);
+}
+
+bool QuickResultConverter::convertRows(jsi::Runtime &rt, size_t maxRows, double budgetMs)
+{
+  size_t rowCount = results != nullptr ? results->rowCount : 0;
+  size_t end = nextRow + std::min(maxRows, rowCount - nextRow);
+  auto start = std::chrono::steady_clock::now();
+  chunks++;
+
+  while (nextRow < end)
+  {
+    rows.setValueAtIndex(rt, nextRow, createRow(rt, nextRow));
+    nextRow++;
+
+    // Reading the clock for every row would add measurable overhead
+    if (budgetMs > 0 && nextRow % 64 == 0 &&
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs)
+    {
+      break;
+    }
+  }
+
+  return nextRow >= rowCount;
+}
+
+jsi::Value QuickResultConverter::createResult(jsi::Runtime &rt)
+{
+  jsi::Object res = jsi::Object(rt);
 
-  for (int ii = 0; ii < values.length(rt); ii++)
+  res.setProperty(rt, "rowsAffected", jsi::Value(status.rowsAffected));
+  if (status.rowsAffected > 0 && status.insertId != 0)
+  {
+    res.setProperty(rt, "insertId", createQuickIntegerValue(rt, status.insertId, options.integerFormat));
+  }
+  if (options.isChunked())
   {
+    res.setProperty(rt, "chunks", jsi::Value((double)chunks));
+  }
 
-    jsi::Value value = values.getValueAtIndex(rt, ii);
-    if (value.isNull() || value.isUndefined())
+  if (options.rowFormat == ROW_ARRAYS)
+  {
+    size_t columnCount = results != nullptr ? results->columns.size() : 0;
+    auto columnNames = jsi::Array(rt, columnCount);
+    for (size_t i = 0; i < columnCount; i++)
     {
-      target->push_back(createNullQuickValue());
+      columnNames.setValueAtIndex(rt, i, jsi::String::createFromUtf8(rt, results->columns[i].columnName));
     }
-    else if (value.isBool())
+    res.setProperty(rt, "columnNames", move(columnNames));
+    res.setProperty(rt, "rows", move(rows));
+    return move(res);
+  }
+
+  size_t rowCount = results != nullptr ? results->rowCount : 0;
+  if (rowCount > 0)
+  {
+    jsi::Object rowsObject = jsi::Object(rt);
+    rowsObject.setProperty(rt, "_array", move(rows));
+    rowsObject.setProperty(rt, "length", jsi::Value((int)rowCount));
+    res.setProperty(rt, "rows", move(rowsObject));
+  }
+
+  if(results != nullptr)
+  {
+    res.setProperty(rt, "metadata", createQuickColumnMetadata(rt, *results));
+  }
+
+  return move(res);
+}
+
+jsi::Value createSequelQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options)
+{
+  if(status.type == SQLiteError) {
+    throw std::invalid_argument(status.errorMessage);
+  }
+
+  QuickExecuteOptions objectOptions = options;
+  objectOptions.rowFormat = ROW_OBJECTS;
+  QuickResultConverter converter(rt, status, results, objectOptions);
+  converter.convertRows(rt, SIZE_MAX, 0);
+  return converter.createResult(rt);
+}
+
+jsi::Value createSequelRawQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options)
+{
+  if(status.type == SQLiteError) {
+    throw std::invalid_argument(status.errorMessage);
+  }
+
+  QuickExecuteOptions arrayOptions = options;
+  arrayOptions.rowFormat = ROW_ARRAYS;
+  QuickResultConverter converter(rt, status, results, arrayOptions);
+  converter.convertRows(rt, SIZE_MAX, 0);
+  return converter.createResult(rt);
+}
+
+QuickLazyRows::QuickLazyRows(jsi::Runtime &rt, shared_ptr<QuickResultSet> results, QuickExecuteOptions options)
+  : results(std::move(results)), options(std::move(options)), columnNames(make_shared<vector<jsi::PropNameID>>())
+{
+  // Property names are created once per result set and shared by all rows
+  columnNames->reserve(this->results->columns.size());
+  for (auto &column : this->results->columns)
+  {
+    columnNames->push_back(jsi::PropNameID::forUtf8(rt, column.columnName));
+  }
+}
+
+jsi::Value QuickLazyRows::createRow(jsi::Runtime &rt, shared_ptr<QuickResultSet> const &results, vector<jsi::PropNameID> const &columnNames, QuickExecuteOptions const &options, size_t row)
+{
+  jsi::Object rowObject = jsi::Object(rt);
+  for (size_t j = 0; j < columnNames.size(); j++)
+  {
+    // Rows are converted on every access, BLOB values are copied so that
+    // writes to one ArrayBuffer do not show up in rows converted later
+    rowObject.setProperty(rt, columnNames[j], createQuickColumnValue(rt, nullptr, results->columns[j], row, options));
+  }
+  return move(rowObject);
+}
+
+jsi::Value QuickLazyRows::get(jsi::Runtime &rt, const jsi::PropNameID &name)
+{
+  string property = name.utf8(rt);
+  if (property == "length")
+  {
+    return jsi::Value((double)results->rowCount);
+  }
+  if (property == "item")
+  {
+    if (item == nullptr)
     {
-      target->push_back(createBooleanQuickValue(value.getBool()));
+      // The function keeps the result set alive for as long as it is referenced
+      auto results = this->results;
+      auto columnNames = this->columnNames;
+      auto options = this->options;
+      item = make_shared<jsi::Function>(jsi::Function::createFromHostFunction(rt, name, 1, [results, columnNames, options](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        if (count < 1 || !args[0].isNumber())
+        {
+          return jsi::Value::undefined();
+        }
+        double index = args[0].asNumber();
+        if (index < 0 || index >= results->rowCount || index != (double)(size_t)index)
+        {
+          return jsi::Value::undefined();
+        }
+        return createRow(rt, results, *columnNames, options, (size_t)index);
+      }));
     }
-    else if (value.isNumber())
+    return jsi::Value(rt, *item);
+  }
+
+  // Array index access, other properties are undefined
+  if (property.empty() || (property.size() > 1 && property[0] == '0') || property.find_first_not_of("0123456789") != string::npos)
+  {
+    return jsi::Value::undefined();
+  }
+  size_t index = std::strtoull(property.c_str(), nullptr, 10);
+  if (index >= results->rowCount)
+  {
+    return jsi::Value::undefined();
+  }
+  return createRow(rt, results, *columnNames, options, index);
+}
+
+vector<jsi::PropNameID> QuickLazyRows::getPropertyNames(jsi::Runtime &rt)
+{
+  vector<jsi::PropNameID> names;
+  names.push_back(jsi::PropNameID::forAscii(rt, "length"));
+  names.push_back(jsi::PropNameID::forAscii(rt, "item"));
+  return names;
+}
+
+jsi::Value createSequelLazyQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options)
+{
+  if(status.type == SQLiteError) {
+    throw std::invalid_argument(status.errorMessage);
+  }
+
+  jsi::Object res = jsi::Object(rt);
+
+  res.setProperty(rt, "rowsAffected", jsi::Value(status.rowsAffected));
+  if (status.rowsAffected > 0 && status.insertId != 0)
+  {
+    res.setProperty(rt, "insertId", createQuickIntegerValue(rt, status.insertId, options.integerFormat));
+  }
+
+  auto lazyResults = results != nullptr ? results : make_shared<QuickResultSet>();
+  auto rows = make_shared<QuickLazyRows>(rt, lazyResults, options);
+  res.setProperty(rt, "rows", jsi::Object::createFromHostObject(rt, rows));
+  if (results != nullptr)
+  {
+    res.setProperty(rt, "metadata", createQuickColumnMetadata(rt, *results));
+  }
+  return move(res);
+}
+
+/**
+ * Returns the length of the valid UTF-8 sequence starting at value[i], or 0
+ * if the bytes are not valid UTF-8. Overlong encodings and surrogates are
+ * invalid.
+ */
+static size_t utf8SequenceLength(const unsigned char *value, size_t size, size_t i)
+{
+  unsigned char c = value[i];
+  size_t length;
+  unsigned char min = 0x80;
+  unsigned char max = 0xbf;
+  if (c >= 0xc2 && c <= 0xdf)
+  {
+    length = 2;
+  }
+  else if (c >= 0xe0 && c <= 0xef)
+  {
+    length = 3;
+    min = c == 0xe0 ? 0xa0 : 0x80;
+    max = c == 0xed ? 0x9f : 0xbf;
+  }
+  else if (c >= 0xf0 && c <= 0xf4)
+  {
+    length = 4;
+    min = c == 0xf0 ? 0x90 : 0x80;
+    max = c == 0xf4 ? 0x8f : 0xbf;
+  }
+  else
+  {
+    return 0;
+  }
+  if (i + length > size || value[i + 1] < min || value[i + 1] > max)
+  {
+    return 0;
+  }
+  for (size_t j = 2; j < length; j++)
+  {
+    if (value[i + j] < 0x80 || value[i + j] > 0xbf)
+    {
+      return 0;
+    }
+  }
+  return length;
+}
+
+void appendJsonString(string &json, const char *value, size_t size)
+{
+  static const char hex[] = "0123456789abcdef";
+  json.push_back('"');
+  for (size_t i = 0; i < size; i++)
+  {
+    char c = value[i];
+    switch (c)
     {
-      double doubleVal = value.asNumber();
-      int intVal = (int)doubleVal;
-      long long longVal = (long)doubleVal;
-      if (intVal == doubleVal)
+    case '"':
+      json.append("\\\"");
+      break;
+    case '\\':
+      json.append("\\\\");
+      break;
+    case '\n':
+      json.append("\\n");
+      break;
+    case '\r':
+      json.append("\\r");
+      break;
+    case '\t':
+      json.append("\\t");
+      break;
+    default:
+      if ((unsigned char)c < 0x20)
       {
-        target->push_back(createIntegerQuickValue(intVal));
+        json.append("\\u00");
+        json.push_back(hex[(c >> 4) & 0xf]);
+        json.push_back(hex[c & 0xf]);
       }
-      else if (longVal == doubleVal)
+      else if ((unsigned char)c < 0x80)
       {
-        target->push_back(createInt64QuickValue(longVal));
+        json.push_back(c);
       }
       else
       {
-        target->push_back(createDoubleQuickValue(doubleVal));
+        size_t length = utf8SequenceLength((const unsigned char *)value, size, i);
+        if (length == 0)
+        {
+          // U+FFFD replacement character
+          json.append("\xef\xbf\xbd");
+        }
+        else
+        {
+          json.append(value + i, length);
+          i += length - 1;
+        }
       }
     }
-    else if (value.isString())
+  }
+  json.push_back('"');
+}
+
+void serializeQuickResultRows(QuickResultSet &results, QuickIntegerFormat integerFormat)
+{
+  string &json = results.json;
+  json.clear();
+
+  // Quoted column names with their separators, shared by all rows
+  vector<string> keys;
+  keys.reserve(results.columns.size());
+  for (size_t j = 0; j < results.columns.size(); j++)
+  {
+    string key = j == 0 ? "{" : ",";
+    appendJsonString(key, results.columns[j].columnName.c_str(), results.columns[j].columnName.size());
+    key.push_back(':');
+    keys.push_back(move(key));
+  }
+
+  // Number.MAX_SAFE_INTEGER
+  const long long maxSafeInteger = 9007199254740991LL;
+  char number[32];
+  json.push_back('[');
+  for (size_t i = 0; i < results.rowCount; i++)
+  {
+    if (i > 0)
+    {
+      json.push_back(',');
+    }
+    if (keys.empty())
     {
-      string strVal = value.asString(rt).utf8(rt);
-      target->push_back(createTextQuickValue(strVal));
+      json.append("{}");
+      continue;
     }
-    else if (value.isObject())
+    for (size_t j = 0; j < results.columns.size(); j++)
     {
-      auto obj = value.asObject(rt);
-      if (obj.isArrayBuffer(rt))
+      auto &column = results.columns[j];
+      json.append(keys[j]);
+      switch (column.typeAt(i))
+      {
+      case TEXT:
       {
-        auto buf = obj.getArrayBuffer(rt);
-        target->push_back(createArrayBufferQuickValueByCopying(buf.data(rt), buf.size(rt)));
+        size_t size;
+        const uint8_t *text = column.bytesAt(i, &size);
+        appendJsonString(json, (const char *)text, size);
+        break;
+      }
+      case INTEGER:
+      {
+        long long value = column.integerAt(i);
+        // JSON numbers are parsed as doubles, integers which would lose
+        // precision are written as strings if BigInt values were requested
+        bool isSafe = value >= -maxSafeInteger && value <= maxSafeInteger;
+        if (integerFormat == INTEGER_BIGINT && !isSafe)
+        {
+          json.push_back('"');
+          json.append(std::to_string(value));
+          json.push_back('"');
+        }
+        else
+        {
+          json.append(std::to_string(value));
+        }
+        break;
+      }
+      case DOUBLE:
+      {
+        double value = column.doubleAt(i);
+        if (std::isfinite(value))
+        {
+          snprintf(number, sizeof(number), "%.17g", value);
+          json.append(number);
+        }
+        else
+        {
+          json.append("null");
+        }
+        break;
+      }
+      default:
+        json.append("null");
       }
     }
-    else
-    {
-      target->push_back(createNullQuickValue());
-    }
+    json.push_back('}');
   }
+  json.push_back(']');
 }
 
-jsi::Value createSequelQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, vector<map<string, QuickValue>> *results, vector<QuickColumnMetadata> *metadata)
+jsi::Value createSequelJsonQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options)
 {
   if(status.type == SQLiteError) {
     throw std::invalid_argument(status.errorMessage);
@@ -140,75 +844,50 @@ jsi::Value createSequelQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult sta
   res.setProperty(rt, "rowsAffected", jsi::Value(status.rowsAffected));
   if (status.rowsAffected > 0 && status.insertId != 0)
   {
-    res.setProperty(rt, "insertId", jsi::Value(status.insertId));
+    res.setProperty(rt, "insertId", createQuickIntegerValue(rt, status.insertId, options.integerFormat));
   }
 
-  // Converting row results into objects
-  size_t rowCount = results->size();
-  jsi::Object rows = jsi::Object(rt);
-  if (rowCount > 0 && metadata != NULL)
+  if (results != nullptr && results->rowCount > 0)
   {
-    auto array = jsi::Array(rt, rowCount);
-    for (int i = 0; i < rowCount; i++)
+    if (results->json.empty())
     {
-      jsi::Object rowObject = jsi::Object(rt);
-      auto row = results -> at(i);
-      // Iterate over metadata to maintain column order
-      for (const auto &column : *metadata)
-      {
-        std::string columnName = column.columnName;
-        auto it = row.find(columnName);
-        if (it != row.end())
-        {
-          QuickValue value = it -> second;
-          if (value.dataType == TEXT)
-          {
-            // using value.textValue (std::string) directly allows jsi::String to use length property of std::string (allowing strings with NULLs in them like SQLite does)
-            rowObject.setProperty(rt, columnName.c_str(), jsi::String::createFromUtf8(rt, value.textValue));
-          } else if (value.dataType == INTEGER)
-          {
-            rowObject.setProperty(rt, columnName.c_str(), jsi::Value(value.doubleOrIntValue));
-          } else if (value.dataType == DOUBLE)
-          {
-            rowObject.setProperty(rt, columnName.c_str(), jsi::Value(value.doubleOrIntValue));
-          } else if (value.dataType == ARRAY_BUFFER)
-          {
-            jsi::Function array_buffer_ctor = rt.global().getPropertyAsFunction(rt, "ArrayBuffer");
-            jsi::Object o = array_buffer_ctor.callAsConstructor(rt, (int) value.arrayBuffer.size()).getObject(rt);
-            jsi::ArrayBuffer buf = o.getArrayBuffer(rt);
-            // It's a shame we have to copy here: see https://github.com/facebook/hermes/pull/419 and https://github.com/facebook/hermes/issues/564.
-            memcpy(buf.data(rt), value.arrayBuffer.data(), value.arrayBuffer.size());
-            rowObject.setProperty(rt, columnName.c_str(), o);
-          } else
-          {
-            rowObject.setProperty(rt, columnName.c_str(), jsi::Value(nullptr));
-          }
-        } else
-        {
-          rowObject.setProperty(rt, columnName.c_str(), jsi::Value(nullptr));
-        }
-      }
-      array.setValueAtIndex(rt, i, move(rowObject));
+      serializeQuickResultRows(*results, options.integerFormat);
     }
-    rows.setProperty(rt, "_array", move(array));
-    res.setProperty(rt, "rows", move(rows));
+    jsi::Object rowsObject = jsi::Object(rt);
+    rowsObject.setProperty(rt, "_array", jsi::Value::createFromJsonUtf8(rt, (const uint8_t *)results->json.data(), results->json.size()));
+    rowsObject.setProperty(rt, "length", jsi::Value((int)results->rowCount));
+    res.setProperty(rt, "rows", move(rowsObject));
   }
 
-  if(metadata != NULL)
+  if (results != nullptr)
   {
-    size_t column_count = metadata->size();
-    auto column_array = jsi::Array(rt, column_count);
-    for (int i = 0; i < column_count; i++) {
-      auto column = metadata->at(i);
-      jsi::Object column_object = jsi::Object(rt);
-      column_object.setProperty(rt, "columnName", jsi::String::createFromUtf8(rt, column.columnName.c_str()));
-      column_object.setProperty(rt, "columnDeclaredType", jsi::String::createFromUtf8(rt, column.columnDeclaredType.c_str()));
-      column_object.setProperty(rt, "columnIndex", jsi::Value(column.columnIndex));
-      column_array.setValueAtIndex(rt, i, move(column_object));
-    }
-    res.setProperty(rt, "metadata", move(column_array));
+    res.setProperty(rt, "metadata", createQuickColumnMetadata(rt, *results));
   }
-  rows.setProperty(rt, "length", jsi::Value((int)rowCount));
-
   return move(res);
 }
+
+jsi::Value createSequelExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options)
+{
+  switch (options.rowFormat)
+  {
+  case ROW_ARRAYS:
+    return createSequelRawQueryExecutionResult(rt, status, results, options);
+  case ROW_LAZY:
+    return createSequelLazyQueryExecutionResult(rt, status, results, options);
+  case ROW_JSON:
+    return createSequelJsonQueryExecutionResult(rt, status, results, options);
+  default:
+    return createSequelQueryExecutionResult(rt, status, results, options);
+  }
+}
+
+jsi::Value createSequelStatementExecutionResults(jsi::Runtime &rt, vector<QuickStatementResult> const &statementResults, QuickExecuteOptions const &options)
+{
+  auto array = jsi::Array(rt, statementResults.size());
+  for (size_t i = 0; i < statementResults.size(); i++)
+  {
+    auto &statementResult = statementResults[i];
+    array.setValueAtIndex(rt, i, createSequelExecutionResult(rt, statementResult.status, statementResult.results, options));
+  }
+  return move(array);
+}
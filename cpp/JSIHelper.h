@@ -13,10 +13,25 @@
 #include <jsi/jsi.h>
 #include <vector>
 #include <map>
+#include <memory>
+#include "ResultArena.h"
+#include <string>
+#include <variant>
 
 using namespace std;
 using namespace facebook;
 
+// jsi::BigInt is supported from JSI version 8, older runtimes only support
+// the number integer mode
+#if JSI_VERSION >= 8
+#define QUICK_SQLITE_JSI_BIGINT 1
+#endif
+
+// ArrayBuffers backed by native memory are supported from JSI version 9
+#if JSI_VERSION >= 9
+#define QUICK_SQLITE_JSI_MUTABLE_BUFFER 1
+#endif
+
 /**
  * Enum for QuickValue to store/determine correct type for dynamic JSI values
  */
@@ -32,25 +47,40 @@ enum QuickDataType
 };
 
 /**
- * Wrapper struct to allocate dynamic JSI values to static C++ primitives
+ * Owned copy of an ArrayBuffer parameter. Move-only, so parameter lists are
+ * never duplicated on their way to the worker thread.
+ */
+struct QuickBlob
+{
+  unique_ptr<uint8_t[]> data;
+  size_t size = 0;
+};
+
+/**
+ * Wrapper struct to allocate dynamic JSI values to static C++ primitives.
+ *
+ * Only one alternative is stored per value. Booleans and integers are stored
+ * as 64 bit integers, short strings are stored inline by std::string.
  */
 struct QuickValue
 {
-  QuickDataType dataType;
-  int booleanValue;
-  double doubleOrIntValue;
-  long long int64Value;
-  string textValue;
-  vector<uint8_t> arrayBuffer;
+  variant<monostate, long long, double, string, QuickBlob> value;
+
+  QuickDataType dataType() const;
+  long long int64Value() const { return get<long long>(value); }
+  double doubleValue() const { return get<double>(value); }
+  string const &textValue() const { return get<string>(value); }
+  QuickBlob const &blobValue() const { return get<QuickBlob>(value); }
 };
 
 /**
- * Helper struct to carry SQLite results between entities
+ * Parameters of a query. Values are bound by position unless names are set.
  */
-struct QuickColumnValue
+struct QuickParameters
 {
-  QuickValue value;
-  string columnName;
+  vector<QuickValue> values;
+  // One name per value for named parameters, empty for positional parameters
+  vector<string> names;
 };
 
 /**
@@ -67,7 +97,7 @@ struct SQLiteOPResult
   ResultType type;
   string errorMessage;
   int rowsAffected;
-  double insertId;
+  long long insertId;
 };
 
 struct SequelLiteralUpdateResult
@@ -86,19 +116,150 @@ struct SequelBatchOperationResult
 };
 
 /**
- * Describe column information of a resultset
+ * Numeric cell value, the active member is determined by the cell type
  */
-struct QuickColumnMetadata
+union QuickNumber
+{
+  long long int64Value;
+  double doubleValue;
+};
+
+/**
+ * TEXT or BLOB value stored outside of a result column
+ */
+struct QuickBytes
+{
+  const uint8_t *data;
+  size_t size;
+};
+
+/**
+ * Column-major storage of a single result column.
+ *
+ * The column name is stored once per result set, cell values are appended to
+ * per-column vectors indexed by row. Vectors grow geometrically and TEXT and
+ * BLOB bytes are copied into the result arena, so reading a result set does
+ * not allocate per row or per cell.
+ */
+struct QuickColumn
 {
   string columnName;
   int columnIndex;
   string columnDeclaredType;
+  // Type of all non-null cells, NULL_VALUE while the column only contains
+  // NULL cells
+  QuickDataType dataType = NULL_VALUE;
+  // Per-cell types, only populated once cells of different types are appended
+  vector<uint8_t> cellTypes;
+  // Null bitmap, one entry per row
+  vector<bool> nulls;
+  // Numeric values, one entry per row once a numeric cell has been appended.
+  // INTEGER cells keep the full 64 bit value, DOUBLE cells the double value.
+  vector<QuickNumber> numbers;
+  // TEXT and BLOB values in the arena of the result set, one entry per row
+  // once a TEXT or BLOB cell has been appended
+  vector<QuickBytes> bytes;
+
+  void appendNull();
+  void appendInteger(long long value);
+  void appendDouble(double value);
+  // The bytes are referenced, not copied. They need to outlive the column.
+  void appendBytes(QuickDataType type, const uint8_t *data, size_t size);
+
+  size_t size() const { return nulls.size(); }
+  QuickDataType typeAt(size_t row) const;
+  long long integerAt(size_t row) const { return numbers[row].int64Value; }
+  double doubleAt(size_t row) const { return numbers[row].doubleValue; }
+  const uint8_t *bytesAt(size_t row, size_t *size) const;
+
+private:
+  void setCellType(QuickDataType type);
+};
+
+/**
+ * Rows returned by a statement, stored column by column
+ */
+struct QuickResultSet
+{
+  vector<QuickColumn> columns;
+  size_t rowCount = 0;
+  // Owns the TEXT and BLOB bytes of all columns
+  ResultArena arena;
+  // The rows serialized by serializeQuickResultRows, empty until serialized
+  string json;
 };
 
 /**
- * Fill the target vector with parsed parameters
+ * Status and rows of a single statement of a multi-statement query
+ */
+struct QuickStatementResult
+{
+  SQLiteOPResult status;
+  shared_ptr<QuickResultSet> results;
+};
+
+/**
+ * Representation of result rows returned to JavaScript
+ */
+enum QuickRowFormat
+{
+  // One object per row, keyed by column name
+  ROW_OBJECTS,
+  // One array of values per row, with the column names returned once
+  ROW_ARRAYS,
+  // A host object which creates row objects when they are accessed
+  ROW_LAZY,
+  // Row objects parsed from a JSON array serialized natively
+  ROW_JSON,
+};
+
+/**
+ * Representation of INTEGER values returned to JavaScript
+ */
+enum QuickIntegerFormat
+{
+  // Doubles, integers beyond 2^53 lose precision
+  INTEGER_NUMBER,
+  // Lossless BigInt values. Only available with QUICK_SQLITE_JSI_BIGINT,
+  // open rejects the BigInt integer mode otherwise.
+  INTEGER_BIGINT,
+};
+
+/**
+ * Options for a single query execution
+ */
+struct QuickExecuteOptions
+{
+  QuickRowFormat rowFormat = ROW_OBJECTS;
+  QuickIntegerFormat integerFormat = INTEGER_NUMBER;
+  // Return a result for every statement of a multi-statement query instead
+  // of only the last one
+  bool allResults = false;
+  // Maximum execution time of the query, zero for no limit
+  double timeoutMs = 0;
+  // Identifies the execution for cancelExecution, empty if not cancellable
+  string cancellationId;
+  // Maximum number of rows converted per JS thread task, zero to convert all
+  // rows at once
+  size_t chunkRows = 0;
+  // Maximum time spent converting rows per JS thread task, zero for no limit
+  double chunkBudgetMs = 0;
+
+  bool isChunked() const { return chunkRows > 0 || chunkBudgetMs > 0; }
+};
+
+/**
+ * Parses execution options passed from JavaScript, undefined selects defaults
+ */
+QuickExecuteOptions jsiExecuteOptions(jsi::Runtime &rt, jsi::Value const &options);
+
+/**
+ * Fill the target with parsed parameters. Arrays are parsed as positional
+ * parameters, other objects as named parameters. Throws for ArrayBuffers and
+ * functions.
  * */
-void jsiQueryArgumentsToSequelParam(jsi::Runtime &rt, jsi::Value const &args, vector<QuickValue> *target);
+void jsiQueryArgumentsToSequelParam(jsi::Runtime &rt, jsi::Value const &args, QuickParameters *target);
+QuickValue jsiValueToQuickValue(jsi::Runtime &rt, jsi::Value const &value);
 
 QuickValue createNullQuickValue();
 QuickValue createBooleanQuickValue(bool value);
@@ -108,6 +269,116 @@ QuickValue createIntegerQuickValue(double value);
 QuickValue createInt64QuickValue(long long value);
 QuickValue createDoubleQuickValue(double value);
 QuickValue createArrayBufferQuickValueByCopying(const uint8_t *arrayBufferValue, size_t arrayBufferSize);
-jsi::Value createSequelQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, vector<map<string, QuickValue>> *results, vector<QuickColumnMetadata> *metadata);
+jsi::Value createQuickIntegerValue(jsi::Runtime &rt, long long value, QuickIntegerFormat format);
+/**
+ * Creates an ArrayBuffer for BLOB bytes owned by the result set. Where the
+ * runtime supports it, the ArrayBuffer references the bytes directly and
+ * keeps the result set alive instead of copying them. The bytes are copied if
+ * owner is null, which callers need to pass if the same value can be
+ * converted more than once.
+ */
+jsi::Value createQuickBlobValue(jsi::Runtime &rt, shared_ptr<QuickResultSet> const &owner, const uint8_t *data, size_t size);
+jsi::Value createQuickColumnValue(jsi::Runtime &rt, shared_ptr<QuickResultSet> const &owner, QuickColumn const &column, size_t row, QuickExecuteOptions const &options);
+jsi::Value createSequelQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options = QuickExecuteOptions());
+jsi::Value createSequelRawQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options);
+/**
+ * Creates the column metadata array of a query result
+ */
+jsi::Value createQuickColumnMetadata(jsi::Runtime &rt, QuickResultSet const &results);
+
+/**
+ * Converts the rows of a result set into the JS result object. Rows can be
+ * converted in several steps, so large results do not block the JS thread for
+ * the whole conversion. Must only be used on the JS thread.
+ */
+class QuickResultConverter
+{
+public:
+  QuickResultConverter(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> results, QuickExecuteOptions options);
+
+  /**
+   * Converts up to maxRows further rows, stopping early once budgetMs have
+   * passed if budgetMs is positive. Returns true once all rows are converted.
+   */
+  bool convertRows(jsi::Runtime &rt, size_t maxRows, double budgetMs);
+
+  /**
+   * Creates the result object from the converted rows, called once after
+   * all rows have been converted
+   */
+  jsi::Value createResult(jsi::Runtime &rt);
+
+private:
+  SQLiteOPResult status;
+  shared_ptr<QuickResultSet> results;
+  QuickExecuteOptions options;
+  vector<jsi::PropNameID> columnNames;
+  jsi::Array rows;
+  size_t nextRow;
+  size_t chunks;
+
+  jsi::Value createRow(jsi::Runtime &rt, size_t row);
+};
+
+/**
+ * Rows of a result set which are only converted to JS objects when they are
+ * indexed. Keeps the native result set alive until the host object is garbage
+ * collected. Supports rows[i], rows.item(i) and rows.length, there is no
+ * _array of all rows.
+ */
+class QuickLazyRows : public jsi::HostObject
+{
+public:
+  QuickLazyRows(jsi::Runtime &rt, shared_ptr<QuickResultSet> results, QuickExecuteOptions options);
+
+  jsi::Value get(jsi::Runtime &rt, const jsi::PropNameID &name) override;
+  vector<jsi::PropNameID> getPropertyNames(jsi::Runtime &rt) override;
+
+private:
+  shared_ptr<QuickResultSet> results;
+  QuickExecuteOptions options;
+  // Shared with the item function, which may outlive the host object
+  shared_ptr<vector<jsi::PropNameID>> columnNames;
+  shared_ptr<jsi::Function> item;
+
+  static jsi::Value createRow(jsi::Runtime &rt, shared_ptr<QuickResultSet> const &results, vector<jsi::PropNameID> const &columnNames, QuickExecuteOptions const &options, size_t row);
+};
+
+/**
+ * Creates a query result with rows backed by a QuickLazyRows host object
+ */
+jsi::Value createSequelLazyQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options);
+
+/**
+ * Appends value as a quoted JSON string, escaping quotes, backslashes and
+ * control characters. Valid UTF-8 sequences are copied as they are, invalid
+ * bytes are replaced with U+FFFD.
+ */
+void appendJsonString(string &json, const char *value, size_t size);
+
+/**
+ * Serializes the rows of the result set into results.json as an array of
+ * objects keyed by column name. INTEGER values are serialized as numbers,
+ * except that with INTEGER_BIGINT integers beyond 2^53 are serialized as
+ * decimal strings. BLOB values and non-finite REAL values are serialized as
+ * null. Does not use the JS runtime, so it can run on the thread the query was
+ * executed on.
+ */
+void serializeQuickResultRows(QuickResultSet &results, QuickIntegerFormat integerFormat);
+
+/**
+ * Creates a query result with the rows parsed from the serialized JSON in a
+ * single call, serializing the rows first if needed
+ */
+jsi::Value createSequelJsonQueryExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options);
+
+/**
+ * Creates a query result in the row format selected by the options
+ */
+jsi::Value createSequelExecutionResult(jsi::Runtime &rt, SQLiteOPResult status, shared_ptr<QuickResultSet> const &results, QuickExecuteOptions const &options);
+/**
+ * Creates an array with the query result of every statement
+ */
+jsi::Value createSequelStatementExecutionResults(jsi::Runtime &rt, vector<QuickStatementResult> const &statementResults, QuickExecuteOptions const &options);
 
 #endif /* JSIHelper_h */
@@ -0,0 +1,51 @@
+#include "LockQueue.h"
+
+LockQueue::LockQueue(unsigned int maxOvertakes)
+    : overtaken(), maxOvertakes(maxOvertakes) {}
+
+void LockQueue::push(std::string const &contextId, LockPriority priority) {
+  if (priority < InteractivePriority || priority > BackgroundPriority) {
+    priority = NormalPriority;
+  }
+  queues[priority].push_back(contextId);
+}
+
+std::string LockQueue::pop() {
+  // Lower priorities which waited too long go first, starting with the lowest
+  for (int priority = BackgroundPriority; priority > InteractivePriority;
+       priority--) {
+    if (!queues[priority].empty() && overtaken[priority] >= maxOvertakes) {
+      return take(priority);
+    }
+  }
+
+  for (int priority = InteractivePriority; priority <= BackgroundPriority;
+       priority++) {
+    if (!queues[priority].empty()) {
+      return take(priority);
+    }
+  }
+  return "";
+}
+
+std::string LockQueue::take(int priority) {
+  std::string contextId = std::move(queues[priority].front());
+  queues[priority].pop_front();
+  overtaken[priority] = 0;
+  for (int lower = priority + 1; lower <= BackgroundPriority; lower++) {
+    if (!queues[lower].empty()) {
+      overtaken[lower]++;
+    }
+  }
+  return contextId;
+}
+
+bool LockQueue::empty() const { return size() == 0; }
+
+size_t LockQueue::size() const {
+  size_t result = 0;
+  for (auto &queue : queues) {
+    result += queue.size();
+  }
+  return result;
+}
@@ -0,0 +1,54 @@
+#include <deque>
+#include <string>
+
+#ifndef LockQueue_h
+#define LockQueue_h
+
+// Number of times a waiting lock request can be overtaken by requests of a
+// higher priority before it is activated regardless
+#define DEFAULT_LOCK_MAX_OVERTAKES 4
+
+enum LockPriority {
+  // Requests which block user interaction
+  InteractivePriority,
+  NormalPriority,
+  // Sync and maintenance work
+  BackgroundPriority,
+};
+
+#define LOCK_PRIORITY_COUNT 3
+
+/**
+ * Queue of lock context IDs waiting for a connection.
+ *
+ * Requests are activated in order of priority and in FIFO order within the
+ * same priority. To prevent starvation, a waiting request which has been
+ * overtaken maxOvertakes times by requests of a higher priority is activated
+ * next. Pushing and popping are O(1).
+ */
+class LockQueue {
+private:
+  std::deque<std::string> queues[LOCK_PRIORITY_COUNT];
+  // Requests activated from higher priorities while the queue was waiting
+  unsigned int overtaken[LOCK_PRIORITY_COUNT];
+  unsigned int maxOvertakes;
+
+  std::string take(int priority);
+
+public:
+  LockQueue(unsigned int maxOvertakes = DEFAULT_LOCK_MAX_OVERTAKES);
+
+  void push(std::string const &contextId, LockPriority priority);
+
+  /**
+   * Removes and returns the next context ID to activate. Must not be called if
+   * the queue is empty.
+   */
+  std::string pop();
+
+  bool empty() const;
+
+  size_t size() const;
+};
+
+#endif
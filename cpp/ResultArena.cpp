@@ -0,0 +1,66 @@
+#include "ResultArena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+ResultArena::ResultArena()
+    : cursor(nullptr), remaining(0),
+      nextChunkSize(RESULT_ARENA_INITIAL_CHUNK_SIZE), used(0) {}
+
+ResultArena::ResultArena(ResultArena &&other) noexcept
+    : chunks(std::move(other.chunks)), cursor(other.cursor),
+      remaining(other.remaining), nextChunkSize(other.nextChunkSize),
+      used(other.used) {
+  other.chunks.clear();
+  other.cursor = nullptr;
+  other.remaining = 0;
+  other.used = 0;
+}
+
+ResultArena &ResultArena::operator=(ResultArena &&other) noexcept {
+  if (this != &other) {
+    chunks = std::move(other.chunks);
+    cursor = other.cursor;
+    remaining = other.remaining;
+    nextChunkSize = other.nextChunkSize;
+    used = other.used;
+    other.chunks.clear();
+    other.cursor = nullptr;
+    other.remaining = 0;
+    other.used = 0;
+  }
+  return *this;
+}
+
+uint8_t *ResultArena::copy(const uint8_t *data, size_t size) {
+  if (size == 0) {
+    // Empty values still need a valid pointer
+    static uint8_t empty;
+    return &empty;
+  }
+
+  uint8_t *target;
+  if (size <= remaining) {
+    target = cursor;
+    cursor += size;
+    remaining -= size;
+  } else if (size > nextChunkSize / 4) {
+    // Large values get a chunk of their own, the current chunk stays
+    // available for smaller values
+    chunks.emplace_back(new uint8_t[size]);
+    target = chunks.back().get();
+  } else {
+    chunks.emplace_back(new uint8_t[nextChunkSize]);
+    target = chunks.back().get();
+    cursor = target + size;
+    remaining = nextChunkSize - size;
+    // Grow chunks geometrically for large result sets
+    nextChunkSize =
+        std::min(nextChunkSize * 2, (size_t)RESULT_ARENA_MAX_CHUNK_SIZE);
+  }
+
+  memcpy(target, data, size);
+  used += size;
+  return target;
+}
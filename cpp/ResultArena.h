@@ -0,0 +1,43 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifndef ResultArena_h
+#define ResultArena_h
+
+#define RESULT_ARENA_INITIAL_CHUNK_SIZE (16 * 1024)
+#define RESULT_ARENA_MAX_CHUNK_SIZE (1024 * 1024)
+
+/**
+ * Bump allocator for the TEXT and BLOB bytes of a single result set.
+ *
+ * Bytes are copied into large chunks which are never moved or freed
+ * individually, so pointers returned by copy() stay valid until the arena is
+ * destroyed. All chunks are released at once together with the result set.
+ */
+class ResultArena {
+private:
+  std::vector<std::unique_ptr<uint8_t[]>> chunks;
+  uint8_t *cursor;
+  size_t remaining;
+  size_t nextChunkSize;
+  size_t used;
+
+public:
+  ResultArena();
+  ResultArena(ResultArena &&other) noexcept;
+  ResultArena &operator=(ResultArena &&other) noexcept;
+
+  /**
+   * Copies size bytes into the arena and returns a pointer to the copy
+   */
+  uint8_t *copy(const uint8_t *data, size_t size);
+
+  /**
+   * Number of bytes copied into the arena
+   */
+  size_t size() const { return used; }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "StatementCache.h"
+
+#include <cctype>
+#include <initializer_list>
+
+int findParameterIndex(sqlite3_stmt *statement, std::string const &name) {
+  if (name.empty()) {
+    return 0;
+  }
+  if (name[0] == ':' || name[0] == '@' || name[0] == '$') {
+    return sqlite3_bind_parameter_index(statement, name.c_str());
+  }
+
+  for (const char *prefix : {":", "@", "$"}) {
+    int index = sqlite3_bind_parameter_index(statement, (prefix + name).c_str());
+    if (index > 0) {
+      return index;
+    }
+  }
+  return 0;
+}
+
+static bool isEmptyTail(const char *tail, const char *end) {
+  while (tail < end && isspace((unsigned char)*tail)) {
+    tail++;
+  }
+  return tail >= end;
+}
+
+StatementCache::StatementCache(size_t capacity)
+    : capacity(capacity), hits(0), misses(0) {}
+
+StatementCache::~StatementCache() { clear(); }
+
+int StatementCache::prepare(sqlite3 *db, std::string const &sql,
+                            sqlite3_stmt **statement, const char **tail) {
+  {
+    std::lock_guard<std::mutex> g(cacheMutex);
+    auto it = index.find(sql);
+    if (it != index.end()) {
+      // Check the statement out of the cache while it is in use
+      *statement = it->second->second;
+      entries.erase(it->second);
+      index.erase(it);
+      hits++;
+      if (tail != nullptr) {
+        // Only queries consisting of a single statement are cached
+        *tail = sql.c_str() + sql.length();
+      }
+      return SQLITE_OK;
+    }
+  }
+
+  // Hint to SQLite that this statement will be reused
+  unsigned int flags = capacity > 0 ? SQLITE_PREPARE_PERSISTENT : 0;
+  const char *statementTail = NULL;
+  int status = sqlite3_prepare_v3(db, sql.c_str(), (int)sql.length(), flags,
+                                  statement, &statementTail);
+  if (tail != nullptr) {
+    *tail = statementTail;
+  }
+
+  // Queries with several statements are never cached and are not counted
+  if (status == SQLITE_OK && *statement != NULL &&
+      isEmptyTail(statementTail, sql.c_str() + sql.length())) {
+    std::lock_guard<std::mutex> g(cacheMutex);
+    misses++;
+  }
+  return status;
+}
+
+void StatementCache::release(std::string const &sql,
+                             sqlite3_stmt *statement) {
+  if (statement == NULL) {
+    return;
+  }
+
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+
+  sqlite3_stmt *evicted = NULL;
+  {
+    std::lock_guard<std::mutex> g(cacheMutex);
+    if (capacity == 0 || index.count(sql) > 0) {
+      // Caching is disabled or an identical statement has been cached in the
+      // meantime
+      evicted = statement;
+    } else {
+      entries.emplace_front(sql, statement);
+      index[sql] = entries.begin();
+
+      if (entries.size() > capacity) {
+        evicted = entries.back().second;
+        index.erase(entries.back().first);
+        entries.pop_back();
+      }
+    }
+  }
+
+  if (evicted != NULL) {
+    {
+      std::lock_guard<std::mutex> g(cacheMutex);
+      parameterIndexes.erase(evicted);
+    }
+    sqlite3_finalize(evicted);
+  }
+}
+
+int StatementCache::parameterIndex(sqlite3_stmt *statement,
+                                   std::string const &name) {
+  std::lock_guard<std::mutex> g(cacheMutex);
+  auto &indexes = parameterIndexes[statement];
+  auto it = indexes.find(name);
+  if (it != indexes.end()) {
+    return it->second;
+  }
+
+  int index = findParameterIndex(statement, name);
+  indexes[name] = index;
+  return index;
+}
+
+void StatementCache::clear() {
+  std::lock_guard<std::mutex> g(cacheMutex);
+  for (auto &entry : entries) {
+    sqlite3_finalize(entry.second);
+  }
+  entries.clear();
+  index.clear();
+  parameterIndexes.clear();
+}
+
+StatementCacheStats StatementCache::stats() {
+  std::lock_guard<std::mutex> g(cacheMutex);
+  return StatementCacheStats{
+      .hits = hits,
+      .misses = misses,
+      .size = entries.size(),
+      .capacity = capacity,
+  };
+}
@@ -0,0 +1,95 @@
+#include "sqlite3.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#ifndef StatementCache_h
+#define StatementCache_h
+
+#define DEFAULT_STATEMENT_CACHE_SIZE 32
+
+struct StatementCacheStats {
+  unsigned long long hits;
+  unsigned long long misses;
+  size_t size;
+  size_t capacity;
+};
+
+/**
+ * Returns the index of a named parameter in the statement, or 0 if the
+ * statement has no such parameter. Names without a prefix match parameters
+ * declared as :name, @name or $name.
+ */
+int findParameterIndex(sqlite3_stmt *statement, std::string const &name);
+
+/**
+ * Bounded LRU cache of prepared statements for a single SQLite connection.
+ *
+ * Statements are keyed by their SQL text. A statement is checked out of the
+ * cache by prepare() and must be handed back with release() once it has been
+ * stepped. Checked out statements are not visible to other callers, which
+ * prevents the same statement from being stepped twice or evicted while in
+ * use.
+ *
+ * release() resets the statement and clears its bindings before it is
+ * returned to the cache, so cached statements never hold a read transaction
+ * open.
+ */
+class StatementCache {
+private:
+  typedef std::pair<std::string, sqlite3_stmt *> Entry;
+
+  size_t capacity;
+  // Most recently used statements are at the front
+  std::list<Entry> entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  // Resolved named parameter indexes of cached statements
+  std::unordered_map<sqlite3_stmt *, std::unordered_map<std::string, int>>
+      parameterIndexes;
+  std::mutex cacheMutex;
+
+  unsigned long long hits;
+  unsigned long long misses;
+
+public:
+  StatementCache(size_t capacity);
+  ~StatementCache();
+
+  /**
+   * Returns a prepared statement for the query. Reuses a cached statement if
+   * one is available, otherwise the query is prepared on the connection.
+   * Returns the SQLite status code of the prepare call. tail is set to the
+   * end of the first statement in sql.
+   *
+   * Only statements which cover the whole sql text may be released back into
+   * the cache, other statements need to be finalized by the caller. Misses are
+   * only counted for such statements.
+   */
+  int prepare(sqlite3 *db, std::string const &sql, sqlite3_stmt **statement,
+              const char **tail = nullptr);
+
+  /**
+   * Resets the statement and returns it to the cache. The least recently used
+   * statement is finalized if the cache is full.
+   */
+  void release(std::string const &sql, sqlite3_stmt *statement);
+
+  /**
+   * Returns the index of a named parameter like findParameterIndex,
+   * remembering the index for as long as the statement is cached. Must only be
+   * called for statements which are released back into the cache.
+   */
+  int parameterIndex(sqlite3_stmt *statement, std::string const &name);
+
+  /**
+   * Finalizes all cached statements. Needs to be called before the connection
+   * is closed and whenever the schema of the connection changes.
+   */
+  void clear();
+
+  StatementCacheStats stats();
+};
+
+#endif
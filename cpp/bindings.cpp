@@ -1,13 +1,18 @@
 #include "bindings.h"
+#include "CancellationToken.h"
 #include "ConnectionPool.h"
 #include "JSIHelper.h"
 #include "logs.h"
 #include "macros.h"
 #include "sqlbatchexecutor.h"
+#include "sqldataexporter.h"
+#include "sqldataimporter.h"
 #include "sqlite3.h"
 #include "sqliteBridge.h"
 #include "sqliteExecute.h"
+#include <cmath>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -18,6 +23,9 @@ namespace osp {
 string docPathStr;
 std::shared_ptr<react::CallInvoker> invoker;
 jsi::Runtime *runtime;
+// Tokens of cancellable executions which have not completed yet, only
+// accessed on the JS thread
+std::map<string, shared_ptr<CancellationToken>> cancellationTokens;
 
 extern "C" {
 int sqlite3_powersync_init(sqlite3 *db, char **pzErrMsg,
@@ -35,6 +43,53 @@ int init_powersync_sqlite_plugin() {
 
 void osp::clearState() { sqliteCloseAll(); }
 
+/**
+ * Creates the error a cancelled execution is rejected with. The error names
+ * match the errors of aborted and timed out fetch requests.
+ */
+jsi::Value createCancellationError(jsi::Runtime &rt, CancellationReason reason,
+                                   QuickExecuteOptions const &options) {
+  string message =
+      reason == CANCEL_TIMEOUT
+          ? "[react-native-quick-sqlite] Query timed out after " +
+                std::to_string((long long)options.timeoutMs) + "ms"
+          : "[react-native-quick-sqlite] Query was cancelled";
+  auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+  auto error = errorCtr.callAsConstructor(
+      rt, jsi::String::createFromUtf8(rt, message));
+  error.asObject(rt).setProperty(
+      rt, "name", reason == CANCEL_TIMEOUT ? "TimeoutError" : "AbortError");
+  return error;
+}
+
+/**
+ * Converts one chunk of the result rows and resolves the promise once all rows
+ * have been converted. Remaining rows are converted in a later JS thread task,
+ * so other work on the JS thread can run in between chunks.
+ */
+void resolveInChunks(jsi::Runtime &rt,
+                     shared_ptr<QuickResultConverter> converter,
+                     QuickExecuteOptions const &options,
+                     shared_ptr<jsi::Value> resolve,
+                     shared_ptr<jsi::Value> reject) {
+  try {
+    size_t maxRows = options.chunkRows > 0 ? options.chunkRows : SIZE_MAX;
+    if (converter->convertRows(rt, maxRows, options.chunkBudgetMs)) {
+      resolve->asObject(rt).asFunction(rt).call(rt,
+                                                converter->createResult(rt));
+    } else {
+      invoker->invokeAsync([&rt, converter, options, resolve, reject] {
+        resolveInChunks(rt, converter, options, resolve, reject);
+      });
+    }
+  } catch (std::exception &exc) {
+    auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+    auto error = errorCtr.callAsConstructor(
+        rt, jsi::String::createFromUtf8(rt, exc.what()));
+    reject->asObject(rt).asFunction(rt).call(rt, error);
+  }
+}
+
 /**
  * Callback handler for SQLite table updates
  */
@@ -155,6 +210,8 @@ void osp::install(jsi::Runtime &rt,
     string dbName = args[0].asString(rt).utf8(rt);
     string tempDocPath = string(docPathStr);
     unsigned int numReadConnections = 0;
+    size_t statementCacheSize = DEFAULT_STATEMENT_CACHE_SIZE;
+    double readIdleTimeoutMs = DEFAULT_READ_IDLE_TIMEOUT_MS;
 
     if (count > 1 && !args[1].isUndefined() && !args[1].isNull()) {
       if (!args[1].isObject()) {
@@ -169,6 +226,35 @@ void osp::install(jsi::Runtime &rt,
         numReadConnections = numReadConnectionsProperty.asNumber();
       }
 
+      auto statementCacheSizeProperty =
+          options.getProperty(rt, "statementCacheSize");
+      if (!statementCacheSizeProperty.isUndefined()) {
+        if (!statementCacheSizeProperty.isNumber() ||
+            !(statementCacheSizeProperty.asNumber() >= 0) ||
+            !std::isfinite(statementCacheSizeProperty.asNumber())) {
+          throw jsi::JSError(rt, "[react-native-quick-sqlite][open] "
+                                 "statementCacheSize must be a non-negative "
+                                 "number");
+        }
+        statementCacheSize = (size_t)statementCacheSizeProperty.asNumber();
+      }
+
+#ifndef QUICK_SQLITE_JSI_BIGINT
+      auto integerModeProperty = options.getProperty(rt, "integerMode");
+      if (integerModeProperty.isString() &&
+          integerModeProperty.asString(rt).utf8(rt) == "bigint") {
+        throw jsi::JSError(rt, "[react-native-quick-sqlite][open] integerMode "
+                               "'bigint' requires a JS runtime with BigInt "
+                               "support in JSI");
+      }
+#endif
+
+      auto readIdleTimeoutProperty =
+          options.getProperty(rt, "readConnectionIdleTimeoutMs");
+      if (readIdleTimeoutProperty.isNumber()) {
+        readIdleTimeoutMs = readIdleTimeoutProperty.asNumber();
+      }
+
       auto locationPropertyProperty = options.getProperty(rt, "location");
       if (!locationPropertyProperty.isUndefined() &&
           !locationPropertyProperty.isNull()) {
@@ -179,7 +265,8 @@ void osp::install(jsi::Runtime &rt,
 
     auto result = sqliteOpenDb(
         dbName, tempDocPath, &contextLockAvailableHandler, &updateTableHandler,
-        &transactionFinalizerHandler, numReadConnections);
+        &transactionFinalizerHandler, numReadConnections, statementCacheSize,
+        readIdleTimeoutMs);
     if (result.type == SQLiteError) {
       throw jsi::JSError(rt, result.errorMessage.c_str());
     }
@@ -355,32 +442,83 @@ void osp::install(jsi::Runtime &rt,
     const string contextLockId = args[1].asString(rt).utf8(rt);
     const string query = args[2].asString(rt).utf8(rt);
     const jsi::Value &originalParams = args[3];
+    const QuickExecuteOptions options =
+        count > 4 ? jsiExecuteOptions(rt, args[4]) : QuickExecuteOptions();
 
     // Converting query parameters inside the javascript caller thread
-    vector<QuickValue> params;
-    jsiQueryArgumentsToSequelParam(rt, originalParams, &params);
+    auto params = make_shared<QuickParameters>();
+    jsiQueryArgumentsToSequelParam(rt, originalParams, params.get());
+
+    shared_ptr<CancellationToken> token;
+    if (options.timeoutMs > 0 || !options.cancellationId.empty()) {
+      token = make_shared<CancellationToken>(options.timeoutMs);
+      if (!options.cancellationId.empty()) {
+        cancellationTokens[options.cancellationId] = token;
+      }
+    }
 
     auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
     auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
       auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
       auto reject = std::make_shared<jsi::Value>(rt, args[1]);
 
-      auto task = [&rt, dbName, contextLockId, query,
-                   params = make_shared<vector<QuickValue>>(params), resolve,
-                   reject](sqlite3 *db) {
+      auto task = [&rt, dbName, contextLockId, query, options, params, token,
+                   resolve, reject](ConnectionState *state) {
         try {
-          vector<map<string, QuickValue>> results;
-          vector<QuickColumnMetadata> metadata;
-          auto status =
-              sqliteExecuteWithDB(db, query, params.get(), &results, &metadata);
+          auto results = make_shared<QuickResultSet>();
+          auto statementResults = make_shared<vector<QuickStatementResult>>();
+          SQLiteOPResult status = {.type = SQLiteError};
+          if (token != nullptr) {
+            token->start();
+          }
+          // Queries cancelled while waiting in the queue are not executed
+          if (token == nullptr || token->check() == NOT_CANCELLED) {
+            ScopedCancellationHandler handler(state->connection, token.get());
+            status = options.allResults
+                         ? sqliteExecuteAllWithDB(
+                               state->connection, query, params.get(),
+                               statementResults.get(), &state->statementCache)
+                         : sqliteExecuteWithDB(state->connection, query,
+                                               params.get(), results.get(),
+                                               &state->statementCache);
+          }
+          if (status.type == SQLiteOk && options.rowFormat == ROW_JSON) {
+            // Serialize here so that the JS thread only needs to parse
+            serializeQuickResultRows(*results, options.integerFormat);
+            for (auto &statementResult : *statementResults) {
+              if (statementResult.results != nullptr) {
+                serializeQuickResultRows(*statementResult.results,
+                                         options.integerFormat);
+              }
+            }
+          }
+          // Executions which completed before the cancellation are resolved
+          CancellationReason cancelled =
+              token != nullptr && status.type != SQLiteOk ? token->cancelled()
+                                                          : NOT_CANCELLED;
           invoker->invokeAsync(
-              [&rt,
-               results = make_shared<vector<map<string, QuickValue>>>(results),
-               metadata = make_shared<vector<QuickColumnMetadata>>(metadata),
+              [&rt, results, statementResults, options, cancelled,
                status_copy = move(status), resolve, reject] {
-                if (status_copy.type == SQLiteOk) {
-                  auto jsiResult = createSequelQueryExecutionResult(
-                      rt, status_copy, results.get(), metadata.get());
+                if (!options.cancellationId.empty()) {
+                  cancellationTokens.erase(options.cancellationId);
+                }
+                if (cancelled != NOT_CANCELLED) {
+                  auto error = createCancellationError(rt, cancelled, options);
+                  reject->asObject(rt).asFunction(rt).call(rt, error);
+                } else if (status_copy.type == SQLiteOk &&
+                           !options.allResults && options.isChunked() &&
+                           (options.rowFormat == ROW_OBJECTS ||
+                            options.rowFormat == ROW_ARRAYS)) {
+                  auto converter = make_shared<QuickResultConverter>(
+                      rt, status_copy, results, options);
+                  resolveInChunks(rt, converter, options, resolve, reject);
+                } else if (status_copy.type == SQLiteOk) {
+                  auto jsiResult =
+                      options.allResults
+                          ? createSequelStatementExecutionResults(
+                                rt, *statementResults, options)
+                          : createSequelExecutionResult(rt, status_copy,
+                                                        results, options);
                   resolve->asObject(rt).asFunction(rt).call(rt,
                                                             move(jsiResult));
                 } else {
@@ -393,12 +531,24 @@ void osp::install(jsi::Runtime &rt,
                 }
               });
         } catch (std::exception &exc) {
-          invoker->invokeAsync([&rt, &exc] { jsi::JSError(rt, exc.what()); });
+          invoker->invokeAsync([&rt, options, message = string(exc.what()),
+                                reject] {
+            if (!options.cancellationId.empty()) {
+              cancellationTokens.erase(options.cancellationId);
+            }
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          });
         }
       };
 
       auto response = sqliteQueueInContext(dbName, contextLockId, task);
       if (response.type == SQLiteError) {
+        if (!options.cancellationId.empty()) {
+          cancellationTokens.erase(options.cancellationId);
+        }
         auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
         auto error = errorCtr.callAsConstructor(
                       rt, jsi::String::createFromUtf8(
@@ -411,6 +561,178 @@ void osp::install(jsi::Runtime &rt,
     return promise;
   });
 
+  auto cancelExecution = HOSTFN("cancelExecution", 1) {
+    if (count < 1) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][cancelExecution] "
+                             "Incorrect arguments for cancelExecution");
+    }
+
+    const string cancellationId = args[0].asString(rt).utf8(rt);
+    auto it = cancellationTokens.find(cancellationId);
+    // Executions which already completed are ignored
+    if (it != cancellationTokens.end()) {
+      it->second->cancel();
+    }
+    return {};
+  });
+
+  auto openCursor = HOSTFN("openCursor", 4) {
+    if (count < 4) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][openCursor] "
+                             "Incorrect arguments for openCursor");
+    }
+
+    const string dbName = args[0].asString(rt).utf8(rt);
+    const string contextLockId = args[1].asString(rt).utf8(rt);
+    const string query = args[2].asString(rt).utf8(rt);
+
+    // Converting query parameters inside the javascript caller thread
+    auto params = make_shared<QuickParameters>();
+    jsiQueryArgumentsToSequelParam(rt, args[3], params.get());
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, query, params, resolve,
+                   reject](ConnectionState *state) {
+        sqlite3_stmt *statement = nullptr;
+        auto status = sqliteOpenCursor(state->connection, query, params.get(),
+                                       &statement);
+        // The statement stays open on this connection until the cursor is
+        // closed or the lock context is released
+        int cursorId =
+            status.type == SQLiteOk ? state->addCursor(statement) : 0;
+        invoker->invokeAsync([&rt, status_copy = move(status), cursorId,
+                              resolve, reject] {
+          if (status_copy.type == SQLiteOk) {
+            resolve->asObject(rt).asFunction(rt).call(rt, jsi::Value(cursorId));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, status_copy.errorMessage));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
+      };
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
+      return {};
+    }));
+
+    return promise;
+  });
+
+  auto fetchCursor = HOSTFN("fetchCursor", 4) {
+    if (count < 4) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][fetchCursor] "
+                             "Incorrect arguments for fetchCursor");
+    }
+
+    const string dbName = args[0].asString(rt).utf8(rt);
+    const string contextLockId = args[1].asString(rt).utf8(rt);
+    const int cursorId = (int)args[2].asNumber();
+    const double maxRows = args[3].asNumber();
+    if (maxRows < 1) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][fetchCursor] "
+                             "At least one row needs to be fetched");
+    }
+    const QuickExecuteOptions options =
+        count > 4 ? jsiExecuteOptions(rt, args[4]) : QuickExecuteOptions();
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, cursorId, maxRows, options, resolve,
+                   reject](ConnectionState *state) {
+        auto results = make_shared<QuickResultSet>();
+        bool done = true;
+        SQLiteOPResult status;
+        sqlite3_stmt *statement = state->getCursor(cursorId);
+        if (statement == nullptr) {
+          status = SQLiteOPResult{
+              .type = SQLiteError,
+              .errorMessage = "[react-native-quick-sqlite] Cursor is not open",
+          };
+        } else {
+          status = sqliteFetchCursor(state->connection, statement,
+                                     (size_t)maxRows, results.get(), &done);
+          if (done || status.type == SQLiteError) {
+            state->closeCursor(cursorId);
+          }
+        }
+        invoker->invokeAsync([&rt, results, status_copy = move(status), done,
+                              options, resolve, reject] {
+          if (status_copy.type == SQLiteOk) {
+            auto jsiResult = createSequelQueryExecutionResult(
+                rt, status_copy, results, options);
+            jsiResult.asObject(rt).setProperty(rt, "done", jsi::Value(done));
+            resolve->asObject(rt).asFunction(rt).call(rt, move(jsiResult));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, status_copy.errorMessage));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
+      };
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
+      return {};
+    }));
+
+    return promise;
+  });
+
+  auto closeCursor = HOSTFN("closeCursor", 3) {
+    if (count < 3) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][closeCursor] "
+                             "Incorrect arguments for closeCursor");
+    }
+
+    const string dbName = args[0].asString(rt).utf8(rt);
+    const string contextLockId = args[1].asString(rt).utf8(rt);
+    const int cursorId = (int)args[2].asNumber();
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, cursorId, resolve](ConnectionState *state) {
+        state->closeCursor(cursorId);
+        invoker->invokeAsync(
+            [&rt, resolve] { resolve->asObject(rt).asFunction(rt).call(rt); });
+      };
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
+      return {};
+    }));
+
+    return promise;
+  });
+
   auto executeBatch = HOSTFN("executeBatch", 2) {
     if (sizeof(args) < 3) {
       throw jsi::JSError(rt, "[react-native-quick-sqlite][executeAsyncBatch] "
@@ -431,35 +753,103 @@ void osp::install(jsi::Runtime &rt,
     const jsi::Array &batchParams = params.asObject(rt).asArray(rt);
     const string contextLockId = args[2].asString(rt).utf8(rt);
 
-    vector<QuickQueryArguments> commands;
-    jsiBatchParametersToQuickArguments(rt, batchParams, &commands);
+    // allResults collects the status and rows of every command
+    const QuickExecuteOptions options =
+        count > 3 ? jsiExecuteOptions(rt, args[3]) : QuickExecuteOptions();
+    bool continueOnError = false;
+    QuickBatchCommitOptions commitOptions;
+    if (count > 3 && args[3].isObject()) {
+      jsi::Object batchOptions = args[3].asObject(rt);
+      jsi::Value continueValue = batchOptions.getProperty(rt, "continueOnError");
+      continueOnError = continueValue.isBool() && continueValue.getBool();
+      jsi::Value commitEvery = batchOptions.getProperty(rt, "commitEvery");
+      if (commitEvery.isNumber() && commitEvery.asNumber() >= 1) {
+        commitOptions.commitEvery = (size_t)commitEvery.asNumber();
+      }
+      jsi::Value checkpoint = batchOptions.getProperty(rt, "checkpoint");
+      commitOptions.checkpoint = checkpoint.isBool() && checkpoint.getBool();
+      jsi::Value onProgress = batchOptions.getProperty(rt, "onProgress");
+      if (onProgress.isObject() && onProgress.asObject(rt).isFunction(rt)) {
+        // Progress is reported from the worker thread, the callback is only
+        // called on the JS thread
+        auto callback = make_shared<jsi::Value>(rt, onProgress);
+        commitOptions.onProgress = [&rt, callback](size_t committed,
+                                                   size_t total) {
+          invoker->invokeAsync([&rt, callback, committed, total] {
+            callback->asObject(rt).asFunction(rt).call(
+                rt, jsi::Value((double)committed), jsi::Value((double)total));
+          });
+        };
+      }
+    }
+
+    auto commands = make_shared<vector<QuickQueryArguments>>();
+    jsiBatchParametersToQuickArguments(rt, batchParams, commands.get());
 
     auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
     auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
       auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
       auto reject = std::make_shared<jsi::Value>(rt, args[1]);
 
-      auto task = [&rt, dbName,
-                   commands =
-                       make_shared<vector<QuickQueryArguments>>(commands),
-                   resolve, reject, contextLockId](sqlite3 *db) {
+      auto task = [&rt, dbName, commands, options, continueOnError,
+                   commitOptions, resolve, reject,
+                   contextLockId](ConnectionState *state) {
         try {
           // Inside the new worker thread, we can now call sqlite operations
-          auto batchResult = sqliteExecuteBatch(db, commands.get());
+          auto commandResults = make_shared<vector<QuickStatementResult>>();
+          auto commandErrors = make_shared<vector<QuickBatchCommandError>>();
+          auto batchResult = sqliteExecuteBatch(
+              state->connection, commands.get(), &state->statementCache,
+              options.allResults ? commandResults.get() : nullptr,
+              continueOnError ? commandErrors.get() : nullptr, commitOptions);
           invoker->invokeAsync(
-              [&rt, batchResult = move(batchResult), resolve, reject] {
+              [&rt, batchResult = move(batchResult), commandResults,
+               commandErrors, options, continueOnError,
+               commitEvery = commitOptions.commitEvery, resolve, reject] {
                 if (batchResult.type == SQLiteOk) {
                   auto res = jsi::Object(rt);
                   res.setProperty(rt, "rowsAffected",
                                   jsi::Value(batchResult.affectedRows));
+                  if (options.allResults) {
+                    res.setProperty(rt, "results",
+                                    createSequelStatementExecutionResults(
+                                        rt, *commandResults, options));
+                  }
+                  if (continueOnError) {
+                    auto errors = jsi::Array(rt, commandErrors->size());
+                    for (size_t i = 0; i < commandErrors->size(); i++) {
+                      auto error = jsi::Object(rt);
+                      error.setProperty(
+                          rt, "index",
+                          jsi::Value((double)commandErrors->at(i).index));
+                      error.setProperty(rt, "message",
+                                        jsi::String::createFromUtf8(
+                                            rt, commandErrors->at(i).message));
+                      errors.setValueAtIndex(rt, i, move(error));
+                    }
+                    res.setProperty(rt, "errors", move(errors));
+                  }
                   resolve->asObject(rt).asFunction(rt).call(rt, move(res));
                 } else {
-                  throw jsi::JSError(rt, batchResult.message);
+                  auto errorCtr =
+                      rt.global().getPropertyAsFunction(rt, "Error");
+                  auto error = errorCtr.callAsConstructor(
+                      rt, jsi::String::createFromUtf8(rt, batchResult.message));
+                  if (commitEvery > 0) {
+                    // Commands of earlier chunks stay committed
+                    error.asObject(rt).setProperty(
+                        rt, "committed", jsi::Value(batchResult.commands));
+                  }
+                  reject->asObject(rt).asFunction(rt).call(rt, error);
                 }
               });
         } catch (std::exception &exc) {
-          invoker->invokeAsync(
-              [&rt, reject, &exc] { throw jsi::JSError(rt, exc.what()); });
+          invoker->invokeAsync([&rt, message = string(exc.what()), reject] {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          });
         }
       };
 
@@ -470,10 +860,75 @@ void osp::install(jsi::Runtime &rt,
     return promise;
   });
 
+  auto executeBulk = HOSTFN("executeBulk", 4) {
+    if (count < 4) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][executeBulk] "
+                             "Incorrect parameter count");
+    }
+
+    const string dbName = args[0].asString(rt).utf8(rt);
+    const string query = args[1].asString(rt).utf8(rt);
+    const string contextLockId = args[3].asString(rt).utf8(rt);
+
+    // Typed array columns are copied here in one piece, so that only strings
+    // and mixed values are converted value by value on the JS thread
+    auto columns = make_shared<vector<QuickBulkColumn>>();
+    size_t rowCount;
+    try {
+      rowCount = jsiBulkColumnsToQuickColumns(
+          rt, args[2].asObject(rt).asArray(rt), columns.get());
+    } catch (std::invalid_argument &exc) {
+      throw jsi::JSError(rt, exc.what());
+    }
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, query, columns, rowCount, resolve,
+                   reject](ConnectionState *state) {
+        SequelBatchOperationResult bulkResult;
+        try {
+          bulkResult = sqliteExecuteBulk(state->connection, query, *columns,
+                                         rowCount, &state->statementCache);
+        } catch (std::exception &exc) {
+          bulkResult = {SQLiteError, exc.what(), 0, 0};
+        }
+
+        invoker->invokeAsync([&rt, bulkResult = move(bulkResult), resolve,
+                              reject] {
+          if (bulkResult.type == SQLiteOk) {
+            auto res = jsi::Object(rt);
+            res.setProperty(rt, "rowsAffected",
+                            jsi::Value(bulkResult.affectedRows));
+            resolve->asObject(rt).asFunction(rt).call(rt, move(res));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, bulkResult.message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
+      };
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
+      return {};
+    }));
+
+    return promise;
+  });
+
   // Load SQL File from disk in another thread
-  auto loadFileAsync = HOSTFN("loadFile", 2) {
-    if (sizeof(args) < 3) {
-      throw jsi::JSError(rt, "[react-native-quick-sqlite][loadFileAsync] "
+  auto loadFile = HOSTFN("loadFile", 3) {
+    if (count < 3) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][loadFile] "
                              "Incorrect parameter count");
       return {};
     }
@@ -487,36 +942,260 @@ void osp::install(jsi::Runtime &rt,
       auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
       auto reject = std::make_shared<jsi::Value>(rt, args[1]);
 
-      auto task = [&rt, dbName, sqlFileName, resolve, reject](sqlite3 *db) {
+      auto task = [&rt, dbName, sqlFileName, resolve,
+                   reject](ConnectionState *state) {
+        SequelBatchOperationResult importResult;
         try {
-          const auto importResult = sqliteImportFile(db, sqlFileName);
-
-          invoker->invokeAsync(
-              [&rt, result = move(importResult), resolve, reject] {
-                if (result.type == SQLiteOk) {
-                  auto res = jsi::Object(rt);
-                  res.setProperty(rt, "rowsAffected",
-                                  jsi::Value(result.affectedRows));
-                  res.setProperty(rt, "commands", jsi::Value(result.commands));
-                  resolve->asObject(rt).asFunction(rt).call(rt, move(res));
-                } else {
-                  throw jsi::JSError(rt, result.message);
-                }
-              });
+          importResult = sqliteImportFile(state->connection, sqlFileName);
         } catch (std::exception &exc) {
-          //          LOGW("Catched exception: %s", exc.what());
-          invoker->invokeAsync(
-              [&rt, err = exc.what(), reject] { throw jsi::JSError(rt, err); });
+          importResult = {SQLiteError, exc.what(), 0, 0};
         }
+
+        invoker->invokeAsync([&rt, result = move(importResult), resolve,
+                              reject] {
+          if (result.type == SQLiteOk) {
+            auto res = jsi::Object(rt);
+            res.setProperty(rt, "rowsAffected",
+                            jsi::Value(result.affectedRows));
+            res.setProperty(rt, "commands", jsi::Value(result.commands));
+            resolve->asObject(rt).asFunction(rt).call(rt, move(res));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, result.message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
       };
-      sqliteQueueInContext(dbName, contextLockId, task);
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
       return {};
     }));
 
     return promise;
   });
 
-  auto requestLock = HOSTFN("requestLock", 3) {
+  // Import a CSV or NDJSON file from disk into a table in another thread
+  auto importData = HOSTFN("importData", 5) {
+    if (count < 5) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][importData] "
+                             "Incorrect parameter count");
+    }
+
+    const string dbName = args[0].asString(rt).utf8(rt);
+    const string fileLocation = args[1].asString(rt).utf8(rt);
+    const string table = args[2].asString(rt).utf8(rt);
+    const string contextLockId = args[4].asString(rt).utf8(rt);
+
+    QuickImportOptions importOptions;
+    if (args[3].isObject()) {
+      jsi::Object options = args[3].asObject(rt);
+      jsi::Value format = options.getProperty(rt, "format");
+      if (format.isString() && format.asString(rt).utf8(rt) == "ndjson") {
+        importOptions.format = IMPORT_NDJSON;
+      }
+      jsi::Value delimiter = options.getProperty(rt, "delimiter");
+      if (delimiter.isString()) {
+        string text = delimiter.asString(rt).utf8(rt);
+        if (text.length() != 1) {
+          throw jsi::JSError(rt, "[react-native-quick-sqlite][importData] "
+                                 "The delimiter must be a single character");
+        }
+        importOptions.delimiter = text[0];
+      }
+      // Maps source fields to table columns
+      jsi::Value columns = options.getProperty(rt, "columns");
+      if (columns.isObject()) {
+        jsi::Object columnMap = columns.asObject(rt);
+        jsi::Array fields = columnMap.getPropertyNames(rt);
+        for (size_t i = 0; i < fields.size(rt); i++) {
+          string field = fields.getValueAtIndex(rt, i).asString(rt).utf8(rt);
+          importOptions.columns.emplace_back(
+              field, columnMap.getProperty(rt, field.c_str())
+                         .asString(rt)
+                         .utf8(rt));
+        }
+      }
+      jsi::Value affinities = options.getProperty(rt, "affinities");
+      if (affinities.isObject()) {
+        jsi::Object affinityMap = affinities.asObject(rt);
+        jsi::Array names = affinityMap.getPropertyNames(rt);
+        for (size_t i = 0; i < names.size(rt); i++) {
+          string column = names.getValueAtIndex(rt, i).asString(rt).utf8(rt);
+          string affinity = affinityMap.getProperty(rt, column.c_str())
+                                .asString(rt)
+                                .utf8(rt);
+          if (affinity == "TEXT") {
+            importOptions.affinities[column] = AFFINITY_TEXT;
+          } else if (affinity == "INTEGER") {
+            importOptions.affinities[column] = AFFINITY_INTEGER;
+          } else if (affinity == "REAL") {
+            importOptions.affinities[column] = AFFINITY_REAL;
+          } else if (affinity == "NUMERIC") {
+            importOptions.affinities[column] = AFFINITY_NUMERIC;
+          } else {
+            throw jsi::JSError(rt, "[react-native-quick-sqlite][importData] "
+                                   "Unknown affinity " +
+                                       affinity);
+          }
+        }
+      }
+      jsi::Value commitEvery = options.getProperty(rt, "commitEvery");
+      if (commitEvery.isNumber() && commitEvery.asNumber() >= 1) {
+        importOptions.commitEvery = (size_t)commitEvery.asNumber();
+      }
+      jsi::Value onProgress = options.getProperty(rt, "onProgress");
+      if (onProgress.isObject() && onProgress.asObject(rt).isFunction(rt)) {
+        auto callback = make_shared<jsi::Value>(rt, onProgress);
+        importOptions.onProgress = [&rt, callback](size_t rows) {
+          invoker->invokeAsync([&rt, callback, rows] {
+            callback->asObject(rt).asFunction(rt).call(rt,
+                                                       jsi::Value((double)rows));
+          });
+        };
+      }
+    }
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, fileLocation, table, importOptions, resolve,
+                   reject](ConnectionState *state) {
+        auto importResult = sqliteImportData(state->connection, fileLocation,
+                                             table, importOptions);
+        invoker->invokeAsync([&rt, result = move(importResult), resolve,
+                              reject] {
+          if (result.type == SQLiteOk) {
+            auto res = jsi::Object(rt);
+            res.setProperty(rt, "rowsAffected",
+                            jsi::Value(result.affectedRows));
+            res.setProperty(rt, "rows", jsi::Value(result.commands));
+            resolve->asObject(rt).asFunction(rt).call(rt, move(res));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, result.message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
+      };
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
+      return {};
+    }));
+
+    return promise;
+  });
+
+  // Export the rows of a query into a file in another thread
+  auto exportData = HOSTFN("exportData", 6) {
+    if (count < 6) {
+      throw jsi::JSError(rt, "[react-native-quick-sqlite][exportData] "
+                             "Incorrect parameter count");
+    }
+
+    const string dbName = args[0].asString(rt).utf8(rt);
+    const string query = args[1].asString(rt).utf8(rt);
+    const string fileLocation = args[3].asString(rt).utf8(rt);
+    const string contextLockId = args[5].asString(rt).utf8(rt);
+
+    auto params = make_shared<QuickParameters>();
+    jsiQueryArgumentsToSequelParam(rt, args[2], params.get());
+
+    QuickExportOptions exportOptions;
+    if (args[4].isObject()) {
+      jsi::Object options = args[4].asObject(rt);
+      jsi::Value format = options.getProperty(rt, "format");
+      if (format.isString()) {
+        string name = format.asString(rt).utf8(rt);
+        if (name == "sql") {
+          exportOptions.format = EXPORT_SQL;
+        } else if (name == "ndjson") {
+          exportOptions.format = EXPORT_NDJSON;
+        }
+      }
+      jsi::Value delimiter = options.getProperty(rt, "delimiter");
+      if (delimiter.isString()) {
+        string text = delimiter.asString(rt).utf8(rt);
+        if (text.length() != 1) {
+          throw jsi::JSError(rt, "[react-native-quick-sqlite][exportData] "
+                                 "The delimiter must be a single character");
+        }
+        exportOptions.delimiter = text[0];
+      }
+      jsi::Value table = options.getProperty(rt, "table");
+      if (table.isString()) {
+        exportOptions.table = table.asString(rt).utf8(rt);
+      }
+      jsi::Value progressEvery = options.getProperty(rt, "progressEvery");
+      if (progressEvery.isNumber() && progressEvery.asNumber() >= 1) {
+        exportOptions.progressEvery = (size_t)progressEvery.asNumber();
+      }
+      jsi::Value onProgress = options.getProperty(rt, "onProgress");
+      if (onProgress.isObject() && onProgress.asObject(rt).isFunction(rt)) {
+        auto callback = make_shared<jsi::Value>(rt, onProgress);
+        exportOptions.onProgress = [&rt, callback](size_t rows) {
+          invoker->invokeAsync([&rt, callback, rows] {
+            callback->asObject(rt).asFunction(rt).call(rt,
+                                                       jsi::Value((double)rows));
+          });
+        };
+      }
+    }
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, query, params, fileLocation, exportOptions, resolve,
+                   reject](ConnectionState *state) {
+        auto exportResult = sqliteExportData(state->connection, query,
+                                             params.get(), fileLocation,
+                                             exportOptions);
+        invoker->invokeAsync([&rt, result = move(exportResult), resolve,
+                              reject] {
+          if (result.type == SQLiteOk) {
+            auto res = jsi::Object(rt);
+            res.setProperty(rt, "rows", jsi::Value(result.commands));
+            resolve->asObject(rt).asFunction(rt).call(rt, move(res));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, result.message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
+      };
+
+      auto response = sqliteQueueInContext(dbName, contextLockId, task);
+      if (response.type == SQLiteError) {
+        auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+        auto error = errorCtr.callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, response.errorMessage));
+        reject->asObject(rt).asFunction(rt).call(rt, error);
+      }
+      return {};
+    }));
+
+    return promise;
+  });
+
+  auto requestLock = HOSTFN("requestLock", 4) {
     if (count < 3) {
       throw jsi::JSError(rt,
                          "[react-native-quick-sqlite][requestLock] "
@@ -531,11 +1210,18 @@ void osp::install(jsi::Runtime &rt,
     string dbName = args[0].asString(rt).utf8(rt);
     string lockId = args[1].asString(rt).utf8(rt);
     ConcurrentLockType lockType = (ConcurrentLockType)args[2].asNumber();
+    LockPriority priority = NormalPriority;
+    if (count > 3 && args[3].isNumber()) {
+      // Unknown priorities, including NaN and fractions, fall back to normal
+      double value = args[3].asNumber();
+      if (value >= InteractivePriority && value <= BackgroundPriority &&
+          value == std::floor(value)) {
+        priority = (LockPriority)value;
+      }
+    }
 
-    auto lockResult = sqliteRequestLock(dbName, lockId, lockType);
-    vector<map<string, QuickValue>> resultsHolder;
-    auto jsiResult =
-        createSequelQueryExecutionResult(rt, lockResult, &resultsHolder, NULL);
+    auto lockResult = sqliteRequestLock(dbName, lockId, lockType, priority);
+    auto jsiResult = createSequelQueryExecutionResult(rt, lockResult, nullptr);
     return jsiResult;
   });
 
@@ -558,20 +1244,52 @@ void osp::install(jsi::Runtime &rt,
     return {};
   });
 
+  auto getStatementCacheStats = HOSTFN("getStatementCacheStats", 1) {
+    if (count == 0 || !args[0].isString()) {
+      throw jsi::JSError(rt,
+                         "[react-native-quick-sqlite][getStatementCacheStats] "
+                         "database name is required");
+    }
+
+    string dbName = args[0].asString(rt).utf8(rt);
+
+    StatementCacheStats stats;
+    auto result = sqliteGetStatementCacheStats(dbName, &stats);
+    if (result.type == SQLiteError) {
+      throw jsi::JSError(rt, result.errorMessage.c_str());
+    }
+
+    auto res = jsi::Object(rt);
+    res.setProperty(rt, "hits", jsi::Value((double)stats.hits));
+    res.setProperty(rt, "misses", jsi::Value((double)stats.misses));
+    res.setProperty(rt, "size", jsi::Value((double)stats.size));
+    res.setProperty(rt, "capacity", jsi::Value((double)stats.capacity));
+    return res;
+  });
+
   jsi::Object module = jsi::Object(rt);
 
   module.setProperty(rt, "open", move(open));
   module.setProperty(rt, "requestLock", move(requestLock));
   module.setProperty(rt, "releaseLock", move(releaseLock));
   module.setProperty(rt, "executeInContext", move(executeInContext));
+  module.setProperty(rt, "cancelExecution", move(cancelExecution));
+  module.setProperty(rt, "openCursor", move(openCursor));
+  module.setProperty(rt, "fetchCursor", move(fetchCursor));
+  module.setProperty(rt, "closeCursor", move(closeCursor));
   module.setProperty(rt, "close", move(close));
   module.setProperty(rt, "refreshSchema", move(refreshSchema));
+  module.setProperty(rt, "getStatementCacheStats",
+                     move(getStatementCacheStats));
 
   module.setProperty(rt, "attach", move(attach));
   module.setProperty(rt, "detach", move(detach));
   module.setProperty(rt, "delete", move(remove));
   module.setProperty(rt, "executeBatch", move(executeBatch));
-  module.setProperty(rt, "loadFileAsync", move(loadFileAsync));
+  module.setProperty(rt, "executeBulk", move(executeBulk));
+  module.setProperty(rt, "loadFile", move(loadFile));
+  module.setProperty(rt, "importData", move(importData));
+  module.setProperty(rt, "exportData", move(exportData));
 
   rt.global().setProperty(rt, "__QuickSQLiteProxy", move(module));
 }
@@ -4,9 +4,36 @@
 #include "sqlbatchexecutor.h"
 #include "fileUtils.h"
 #include "sqliteExecute.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <stdexcept>
 #include <iostream>
 
+/**
+ * Whether the value is a set of parameters, either an array of positional
+ * parameters or a plain object of named parameters. ArrayBuffers, typed arrays
+ * and other values are single parameter values.
+ */
+static bool isParameterSet(jsi::Runtime &rt, jsi::Value const &value) {
+  if (!value.isObject()) {
+    return false;
+  }
+  jsi::Object object = value.asObject(rt);
+  if (object.isArray(rt)) {
+    return true;
+  }
+  if (object.isArrayBuffer(rt) || object.isFunction(rt)) {
+    return false;
+  }
+  // Typed arrays and DataViews are views on an ArrayBuffer
+  jsi::Value buffer = object.getProperty(rt, "buffer");
+  return !(buffer.isObject() && buffer.asObject(rt).isArrayBuffer(rt));
+}
+
 void jsiBatchParametersToQuickArguments(jsi::Runtime &rt,
                                         jsi::Array const &batchParams,
                                         vector<QuickQueryArguments> *commands) {
@@ -21,36 +48,249 @@ void jsiBatchParametersToQuickArguments(jsi::Runtime &rt,
     const jsi::Value &commandParams = command.length(rt) > 1
                                           ? command.getValueAtIndex(rt, 1)
                                           : jsi::Value::undefined();
-    if (!commandParams.isUndefined() &&
-        commandParams.asObject(rt).isArray(rt) &&
+    if (commandParams.isObject() && commandParams.asObject(rt).isArray(rt) &&
         commandParams.asObject(rt).asArray(rt).length(rt) > 0 &&
-        commandParams.asObject(rt)
-            .asArray(rt)
-            .getValueAtIndex(rt, 0)
-            .isObject()) {
+        isParameterSet(rt, commandParams.asObject(rt)
+                               .asArray(rt)
+                               .getValueAtIndex(rt, 0))) {
       // This arguments is an array of arrays, like a batch update of a single
       // sql command.
       const jsi::Array &batchUpdateParams =
           commandParams.asObject(rt).asArray(rt);
-      for (int x = 0; x < batchUpdateParams.length(rt); x++) {
+      size_t paramSetCount = batchUpdateParams.length(rt);
+      QuickQueryArguments arguments{query};
+      arguments.params.resize(paramSetCount);
+      for (size_t x = 0; x < paramSetCount; x++) {
         const jsi::Value &p = batchUpdateParams.getValueAtIndex(rt, x);
-        vector<QuickValue> params;
-        jsiQueryArgumentsToSequelParam(rt, p, &params);
-        commands->push_back(QuickQueryArguments{
-            query, make_shared<vector<QuickValue>>(params)});
+        jsiQueryArgumentsToSequelParam(rt, p, &arguments.params[x]);
+      }
+      commands->push_back(move(arguments));
+    } else {
+      QuickQueryArguments arguments{query};
+      arguments.params.resize(1);
+      jsiQueryArgumentsToSequelParam(rt, commandParams, &arguments.params[0]);
+      commands->push_back(move(arguments));
+    }
+  }
+}
+
+size_t QuickBulkColumn::size() const {
+  switch (type) {
+  case BULK_INT32:
+    return bytes.size() / sizeof(int32_t);
+  case BULK_INT64:
+    return bytes.size() / sizeof(int64_t);
+  case BULK_FLOAT64:
+    return bytes.size() / sizeof(double);
+  default:
+    return values.size();
+  }
+}
+
+void QuickBulkColumn::bind(sqlite3_stmt *statement, int sqIndex,
+                           size_t row) const {
+  // The bytes of a typed array are not necessarily aligned
+  switch (type) {
+  case BULK_INT32: {
+    int32_t value;
+    memcpy(&value, bytes.data() + row * sizeof(value), sizeof(value));
+    sqlite3_bind_int(statement, sqIndex, value);
+    break;
+  }
+  case BULK_INT64: {
+    int64_t value;
+    memcpy(&value, bytes.data() + row * sizeof(value), sizeof(value));
+    sqlite3_bind_int64(statement, sqIndex, value);
+    break;
+  }
+  case BULK_FLOAT64: {
+    double value;
+    memcpy(&value, bytes.data() + row * sizeof(value), sizeof(value));
+    // SQLite binds NaN as NULL
+    sqlite3_bind_double(statement, sqIndex, value);
+    break;
+  }
+  default:
+    bindValue(statement, sqIndex, values[row]);
+    break;
+  }
+}
+
+size_t jsiBulkColumnsToQuickColumns(jsi::Runtime &rt, jsi::Array const &columns,
+                                    vector<QuickBulkColumn> *bulkColumns) {
+  size_t columnCount = columns.length(rt);
+  size_t rowCount = 0;
+  bulkColumns->resize(columnCount);
+
+  for (size_t i = 0; i < columnCount; i++) {
+    QuickBulkColumn &bulkColumn = bulkColumns->at(i);
+    jsi::Object column = columns.getValueAtIndex(rt, i).asObject(rt);
+
+    if (column.isArray(rt)) {
+      jsi::Array values = column.asArray(rt);
+      size_t length = values.length(rt);
+      bulkColumn.type = BULK_VALUES;
+      bulkColumn.values.reserve(length);
+      for (size_t row = 0; row < length; row++) {
+        bulkColumn.values.push_back(
+            jsiValueToQuickValue(rt, values.getValueAtIndex(rt, row)));
+      }
+    } else {
+      const string type = column.getProperty(rt, "type").asString(rt).utf8(rt);
+      size_t elementSize;
+      if (type == "int32") {
+        bulkColumn.type = BULK_INT32;
+        elementSize = sizeof(int32_t);
+      } else if (type == "int64") {
+        bulkColumn.type = BULK_INT64;
+        elementSize = sizeof(int64_t);
+      } else if (type == "float64") {
+        bulkColumn.type = BULK_FLOAT64;
+        elementSize = sizeof(double);
+      } else {
+        throw std::invalid_argument(
+            "[react-native-quick-sqlite] Unsupported bulk column type: " +
+            type);
+      }
+
+      jsi::ArrayBuffer buffer =
+          column.getProperty(rt, "buffer").asObject(rt).getArrayBuffer(rt);
+      size_t byteOffset =
+          (size_t)column.getProperty(rt, "byteOffset").asNumber();
+      size_t length = (size_t)column.getProperty(rt, "length").asNumber();
+      size_t byteLength = length * elementSize;
+      if (byteOffset + byteLength > buffer.size(rt)) {
+        throw std::invalid_argument(
+            "[react-native-quick-sqlite] Bulk column exceeds its buffer");
+      }
+      // A single copy, the buffer may be modified or collected once the
+      // call returns
+      const uint8_t *data = buffer.data(rt) + byteOffset;
+      bulkColumn.bytes.assign(data, data + byteLength);
+    }
+
+    if (i == 0) {
+      rowCount = bulkColumn.size();
+    } else if (bulkColumn.size() != rowCount) {
+      throw std::invalid_argument("[react-native-quick-sqlite] Bulk columns "
+                                  "must have the same length");
+    }
+  }
+
+  return rowCount;
+}
+
+SequelBatchOperationResult
+sqliteExecuteBulk(sqlite3 *db, string const &sql,
+                  vector<QuickBulkColumn> const &columns, size_t rowCount,
+                  StatementCache *statementCache) {
+  try {
+    sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
+
+    auto result = sqliteExecuteRepeatedWithDB(
+        db, sql, rowCount,
+        [&columns](sqlite3_stmt *statement, size_t row) {
+          for (size_t i = 0; i < columns.size(); i++) {
+            columns[i].bind(statement, (int)i + 1, row);
+          }
+        },
+        statementCache);
+    if (result.type == SQLiteError) {
+      sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+      return SequelBatchOperationResult{
+          .type = SQLiteError,
+          .message = result.errorMessage,
+      };
+    }
+
+    sqliteExecuteLiteralWithDB(db, "COMMIT");
+    return SequelBatchOperationResult{
+        .type = SQLiteOk,
+        .affectedRows = result.rowsAffected,
+        .commands = (int)rowCount,
+    };
+  } catch (std::exception &exc) {
+    sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+    return SequelBatchOperationResult{
+        .type = SQLiteError,
+        .message = exc.what(),
+    };
+  }
+}
+
+/**
+ * Executes each of the count parameter sets in its own savepoint. Failed
+ * executions are rolled back to their savepoint and recorded in commandErrors,
+ * index is the batch index of the first parameter set. Returns an error only
+ * if the batch cannot continue.
+ */
+static SQLiteOPResult
+executeCommandInSavepoints(sqlite3 *db, string const &sql,
+                           QuickParameters *paramSets, size_t count,
+                           size_t index, StatementCache *statementCache,
+                           vector<QuickStatementResult> *commandResults,
+                           vector<QuickBatchCommandError> *commandErrors) {
+  QuickParameters noParams;
+  int rowsAffected = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    auto savepoint = sqliteExecuteWithDB(db, "SAVEPOINT quick_sqlite_batch",
+                                         &noParams, NULL, statementCache);
+    if (savepoint.type == SQLiteError) {
+      return savepoint;
+    }
+
+    auto results = make_shared<QuickResultSet>();
+    auto status =
+        sqliteExecuteWithDB(db, sql, &paramSets[i],
+                            commandResults != nullptr ? results.get() : NULL,
+                            statementCache);
+
+    if (status.type == SQLiteError) {
+      if (sqlite3_get_autocommit(db)) {
+        // Some errors roll back the whole transaction, no savepoint is left
+        return status;
+      }
+      auto rollback =
+          sqliteExecuteWithDB(db, "ROLLBACK TO quick_sqlite_batch", &noParams,
+                              NULL, statementCache);
+      if (rollback.type == SQLiteError) {
+        return rollback;
       }
+      commandErrors->push_back(
+          QuickBatchCommandError{.index = index + i,
+                                 .message = status.errorMessage});
+      // Keep results aligned with the batch index
+      status = SQLiteOPResult{.type = SQLiteOk, .rowsAffected = 0};
+      results = make_shared<QuickResultSet>();
     } else {
-      vector<QuickValue> params;
-      jsiQueryArgumentsToSequelParam(rt, commandParams, &params);
-      commands->push_back(
-          QuickQueryArguments{query, make_shared<vector<QuickValue>>(params)});
+      rowsAffected += status.rowsAffected;
+    }
+
+    auto release = sqliteExecuteWithDB(db, "RELEASE quick_sqlite_batch",
+                                       &noParams, NULL, statementCache);
+    if (release.type == SQLiteError) {
+      return release;
+    }
+    if (commandResults != nullptr) {
+      commandResults->push_back(
+          QuickStatementResult{.status = status, .results = results});
     }
   }
+
+  return SQLiteOPResult{.type = SQLiteOk, .rowsAffected = rowsAffected};
 }
 
 SequelBatchOperationResult
-sqliteExecuteBatch(sqlite3 *db, vector<QuickQueryArguments> *commands) {
-  size_t commandCount = commands->size();
+sqliteExecuteBatch(sqlite3 *db, vector<QuickQueryArguments> *commands,
+                   StatementCache *statementCache,
+                   vector<QuickStatementResult> *commandResults,
+                   vector<QuickBatchCommandError> *commandErrors,
+                   QuickBatchCommitOptions const &commitOptions) {
+  size_t commandCount = 0;
+  for (auto &command : *commands) {
+    commandCount += command.params.size();
+  }
   if (commandCount <= 0) {
     return SequelBatchOperationResult{
         .type = SQLiteError,
@@ -58,28 +298,87 @@ sqliteExecuteBatch(sqlite3 *db, vector<QuickQueryArguments> *commands) {
     };
   }
 
+  // Commands committed by intermediate commits stay committed on errors
+  size_t committed = 0;
   try {
     int affectedRows = 0;
 
     sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
 
-    for (int i = 0; i < commandCount; i++) {
-      auto command = commands->at(i);
-      // We do not provide a datastructure to receive query data because we
-      // don't need/want to handle this results in a batch execution
-      auto result = sqliteExecuteWithDB(db, command.sql, command.params.get(),
-                                        NULL, NULL);
-      if (result.type == SQLiteError) {
-        sqliteExecuteLiteralWithDB(db, "ROLLBACK");
-        return SequelBatchOperationResult{
-            .type = SQLiteError,
-            .message = result.errorMessage,
-        };
-      } else {
+    size_t commitEvery = commitOptions.commitEvery;
+    size_t index = 0;
+    for (auto &command : *commands) {
+      size_t offset = 0;
+      while (offset < command.params.size()) {
+        // Split the parameter sets of a command at chunk boundaries
+        size_t count = command.params.size() - offset;
+        if (commitEvery > 0) {
+          count = std::min(count, commitEvery - (index - committed));
+        }
+
+        SQLiteOPResult result;
+        if (commandErrors != nullptr) {
+          result = executeCommandInSavepoints(
+              db, command.sql, &command.params[offset], count, index,
+              statementCache, commandResults, commandErrors);
+        } else {
+          // Each command is prepared once for all of its parameter sets. Rows
+          // are only read if the caller collects the results of the commands
+          result = sqliteExecuteRepeatedWithDB(db, command.sql,
+                                               &command.params[offset], count,
+                                               statementCache, commandResults);
+        }
+        offset += count;
+        index += count;
+
+        if (result.type == SQLiteError) {
+          sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+          return SequelBatchOperationResult{
+              .type = SQLiteError,
+              .message = result.errorMessage,
+              .affectedRows = affectedRows,
+              .commands = (int)committed,
+          };
+        }
         affectedRows += result.rowsAffected;
+
+        if (commitEvery > 0 && index - committed >= commitEvery &&
+            index < commandCount) {
+          auto commit = sqliteExecuteLiteralWithDB(db, "COMMIT");
+          if (commit.type == SQLiteError) {
+            sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+            return SequelBatchOperationResult{
+                .type = SQLiteError,
+                .message = commit.message,
+                .commands = (int)committed,
+            };
+          }
+          committed = index;
+          if (commitOptions.checkpoint) {
+            // Passive checkpoints do not wait for readers, the WAL is reset
+            // once a later checkpoint caught up with all of them
+            sqlite3_wal_checkpoint_v2(db, NULL, SQLITE_CHECKPOINT_PASSIVE, NULL,
+                                      NULL);
+          }
+          if (commitOptions.onProgress) {
+            commitOptions.onProgress(committed, commandCount);
+          }
+          sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
+        }
       }
     }
-    sqliteExecuteLiteralWithDB(db, "COMMIT");
+    auto commit = sqliteExecuteLiteralWithDB(db, "COMMIT");
+    if (commit.type == SQLiteError) {
+      sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+      return SequelBatchOperationResult{
+          .type = SQLiteError,
+          .message = commit.message,
+          .commands = (int)committed,
+      };
+    }
+    if (commitOptions.onProgress) {
+      commitOptions.onProgress(commandCount, commandCount);
+    }
     return SequelBatchOperationResult{
         .type = SQLiteOk,
         .affectedRows = affectedRows,
@@ -90,48 +389,387 @@ sqliteExecuteBatch(sqlite3 *db, vector<QuickQueryArguments> *commands) {
     return SequelBatchOperationResult{
         .type = SQLiteError,
         .message = exc.what(),
+        .commands = (int)committed,
     };
   }
 }
 
-SequelBatchOperationResult sqliteImportFile(sqlite3 *db,
-                                            const std::string fileLocation) {
-  std::string line;
-  std::ifstream sqFile(fileLocation);
-
-  if (sqFile.is_open()) {
-    try {
-      int affectedRows = 0;
-      int commands = 0;
-      sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
-      while (std::getline(sqFile, line, '\n')) {
-        if (!line.empty()) {
-          SequelLiteralUpdateResult result =
-              sqliteExecuteLiteralWithDB(db, line);
-          if (result.type == SQLiteError) {
-            sqliteExecuteLiteralWithDB(db, "ROLLBACK");
-            sqFile.close();
-            return {SQLiteError, result.message, 0, commands};
-          } else {
-            affectedRows += result.affectedRows;
-            commands++;
+static bool isIdentifierChar(char c) {
+  return isalnum((unsigned char)c) || c == '_' || c == '$' ||
+         (unsigned char)c >= 0x80;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/**
+ * Replaces the string, blob and number literals of an INSERT statement with
+ * parameters, so that INSERT statements of the same shape share a prepared
+ * statement. Returns false if the statement should be executed as it is, like
+ * statements which are not INSERTs, contain a SELECT or already have
+ * parameters.
+ */
+static bool parameterizeInsert(string const &sql, string *normalized,
+                               QuickParameters *params) {
+  size_t length = sql.length();
+  size_t i = 0;
+  bool isFirstWord = true;
+  normalized->clear();
+  normalized->reserve(length);
+
+  while (i < length) {
+    char c = sql[i];
+    char previous = i > 0 ? sql[i - 1] : ' ';
+
+    if (c == '-' && i + 1 < length && sql[i + 1] == '-') {
+      // Line comment
+      size_t end = sql.find('\n', i);
+      i = end == string::npos ? length : end;
+    } else if (c == '/' && i + 1 < length && sql[i + 1] == '*') {
+      size_t end = sql.find("*/", i + 2);
+      i = end == string::npos ? length : end + 2;
+      normalized->push_back(' ');
+    } else if (c == '"' || c == '`' || c == '[') {
+      // Quoted identifiers are kept
+      char close = c == '[' ? ']' : c;
+      size_t end = sql.find(close, i + 1);
+      if (end == string::npos) {
+        return false;
+      }
+      normalized->append(sql, i, end + 1 - i);
+      i = end + 1;
+    } else if (c == '\'' ||
+               ((c == 'x' || c == 'X') && i + 1 < length &&
+                sql[i + 1] == '\'' && !isIdentifierChar(previous))) {
+      bool isBlob = c != '\'';
+      size_t j = isBlob ? i + 2 : i + 1;
+      string value;
+      while (true) {
+        if (j >= length) {
+          return false;
+        }
+        if (sql[j] == '\'') {
+          if (j + 1 < length && sql[j + 1] == '\'') {
+            value.push_back('\'');
+            j += 2;
+            continue;
           }
+          break;
         }
+        value.push_back(sql[j++]);
+      }
+      i = j + 1;
+
+      if (isBlob) {
+        if (value.length() % 2 != 0) {
+          return false;
+        }
+        vector<uint8_t> bytes(value.length() / 2);
+        for (size_t b = 0; b < bytes.size(); b++) {
+          int high = hexValue(value[b * 2]);
+          int low = hexValue(value[b * 2 + 1]);
+          if (high < 0 || low < 0) {
+            return false;
+          }
+          bytes[b] = (uint8_t)(high << 4 | low);
+        }
+        params->values.push_back(
+            createArrayBufferQuickValueByCopying(bytes.data(), bytes.size()));
+      } else {
+        params->values.push_back(createTextQuickValue(move(value)));
+      }
+      normalized->push_back('?');
+    } else if ((isdigit((unsigned char)c) ||
+                (c == '.' && i + 1 < length &&
+                 isdigit((unsigned char)sql[i + 1]))) &&
+               !isIdentifierChar(previous)) {
+      size_t j = i;
+      bool isReal = false;
+      while (j < length && isdigit((unsigned char)sql[j])) {
+        j++;
+      }
+      if (j < length && sql[j] == '.') {
+        isReal = true;
+        j++;
+        while (j < length && isdigit((unsigned char)sql[j])) {
+          j++;
+        }
+      }
+      if (j < length && (sql[j] == 'e' || sql[j] == 'E')) {
+        isReal = true;
+        j++;
+        if (j < length && (sql[j] == '+' || sql[j] == '-')) {
+          j++;
+        }
+        while (j < length && isdigit((unsigned char)sql[j])) {
+          j++;
+        }
+      }
+      if (j < length && (isIdentifierChar(sql[j]) || sql[j] == '.')) {
+        // Hex integers and malformed numbers
+        return false;
+      }
+
+      string number = sql.substr(i, j - i);
+      errno = 0;
+      long long integer = isReal ? 0 : strtoll(number.c_str(), nullptr, 10);
+      if (errno == ERANGE) {
+        // SQLite reads -9223372036854775808 as an INTEGER, but only the
+        // digits without the sign are parameterized here
+        return false;
+      }
+      if (isReal) {
+        params->values.push_back(
+            createDoubleQuickValue(strtod(number.c_str(), nullptr)));
+      } else {
+        params->values.push_back(createInt64QuickValue(integer));
+      }
+      normalized->push_back('?');
+      i = j;
+    } else if (isIdentifierChar(c)) {
+      size_t j = i;
+      while (j < length && isIdentifierChar(sql[j])) {
+        j++;
+      }
+      string word = sql.substr(i, j - i);
+      std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+      if (isFirstWord && word != "INSERT" && word != "REPLACE") {
+        return false;
+      }
+      if (word == "SELECT") {
+        // Numbers can refer to result columns in SELECT statements
+        return false;
+      }
+      isFirstWord = false;
+      normalized->append(sql, i, j - i);
+      i = j;
+    } else if (c == '?' || c == ':' || c == '@' || c == '$') {
+      return false;
+    } else {
+      normalized->push_back(c);
+      i++;
+    }
+  }
+
+  return !isFirstWord && !params->values.empty();
+}
+
+/**
+ * Executes a single complete statement of an imported file. INSERT statements
+ * are parameterized so that statements of the same shape reuse a prepared
+ * statement from the cache.
+ */
+static SQLiteOPResult executeImportStatement(sqlite3 *db, string const &sql,
+                                             StatementCache *statementCache) {
+  string normalized;
+  QuickParameters params;
+  if (parameterizeInsert(sql, &normalized, &params)) {
+    // Statements with more literals than the parameter limit fail to prepare
+    // and are executed as they are. Any other error of the parameterized
+    // statement is the error of the statement.
+    sqlite3_stmt *statement = NULL;
+    const char *tail = NULL;
+    if (statementCache->prepare(db, normalized, &statement, &tail) ==
+        SQLITE_OK) {
+      if (statement != NULL && *tail == '\0') {
+        return sqliteExecutePreparedWithDB(db, normalized, statement, &params,
+                                           statementCache);
+      }
+      sqlite3_finalize(statement);
+      return sqliteExecuteWithDB(db, normalized, &params, NULL, statementCache);
+    }
+  }
+
+  QuickParameters noParams;
+  return sqliteExecuteWithDB(db, sql, &noParams, NULL, nullptr);
+}
+
+/**
+ * Finds the ends of complete statements like sqlite3_complete, a semicolon
+ * only ends a statement outside of literals, comments and trigger bodies.
+ * The state is kept between calls, so that text which is appended while
+ * reading a file is scanned once.
+ */
+class StatementScanner {
+public:
+  /**
+   * Returns the position after the next complete statement in text, or
+   * string::npos if the rest of the text is not a complete statement yet.
+   */
+  size_t next(string const &text) {
+    // Tokens and state transitions of sqlite3_complete
+    enum { SEMI, WS, OTHER, EXPLAIN, CREATE, TEMP, TRIGGER, END };
+    static const uint8_t transitions[8][8] = {
+        // SEMI  WS  OTHER  EXPLAIN  CREATE  TEMP  TRIGGER  END
+        {1, 0, 2, 3, 4, 2, 2, 2}, // 0 INVALID
+        {1, 1, 2, 3, 4, 2, 2, 2}, // 1 START
+        {1, 2, 2, 2, 2, 2, 2, 2}, // 2 NORMAL
+        {1, 3, 3, 2, 4, 2, 2, 2}, // 3 EXPLAIN
+        {1, 4, 2, 2, 2, 4, 5, 2}, // 4 CREATE
+        {6, 5, 5, 5, 5, 5, 5, 5}, // 5 TRIGGER
+        {6, 6, 5, 5, 5, 5, 5, 7}, // 6 SEMI
+        {1, 7, 5, 5, 5, 5, 5, 5}, // 7 END
+    };
+    size_t length = text.length();
+
+    while (position < length) {
+      // Tokens which could continue in text that has not been read yet are
+      // scanned again on the next call
+      size_t i = position;
+      char c = text[i];
+      int token = OTHER;
+
+      if (c == ';') {
+        token = SEMI;
+        i++;
+      } else if (isspace((unsigned char)c)) {
+        token = WS;
+        i++;
+      } else if ((c == '-' || c == '/') && i + 1 >= length) {
+        return string::npos;
+      } else if (c == '-' && text[i + 1] == '-') {
+        size_t end = text.find('\n', i + 2);
+        if (end == string::npos) {
+          return string::npos;
+        }
+        token = WS;
+        i = end + 1;
+      } else if (c == '/' && text[i + 1] == '*') {
+        size_t end = text.find("*/", i + 2);
+        if (end == string::npos) {
+          return string::npos;
+        }
+        token = WS;
+        i = end + 2;
+      } else if (c == '\'' || c == '"' || c == '`' || c == '[') {
+        size_t end = text.find(c == '[' ? ']' : c, i + 1);
+        if (end == string::npos) {
+          return string::npos;
+        }
+        i = end + 1;
+      } else if (isIdentifierChar(c)) {
+        size_t end = i;
+        while (end < length && isIdentifierChar(text[end])) {
+          end++;
+        }
+        if (end == length) {
+          return string::npos;
+        }
+        string word = text.substr(i, end - i);
+        std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+        if (word == "CREATE") {
+          token = CREATE;
+        } else if (word == "TRIGGER") {
+          token = TRIGGER;
+        } else if (word == "TEMP" || word == "TEMPORARY") {
+          token = TEMP;
+        } else if (word == "END") {
+          token = END;
+        } else if (word == "EXPLAIN") {
+          token = EXPLAIN;
+        }
+        i = end;
+      } else {
+        i++;
+      }
+
+      position = i;
+      state = transitions[state][token];
+      if (token == SEMI && state == 1) {
+        state = 0;
+        return position;
       }
-      sqFile.close();
-      sqliteExecuteLiteralWithDB(db, "COMMIT");
-      return {SQLiteOk, "", affectedRows, commands};
-    } catch (...) {
-      sqFile.close();
-      sqliteExecuteLiteralWithDB(db, "ROLLBACK");
-      return {SQLiteError,
-              "[react-native-quick-sqlite][loadSQLFile] Unexpected error, "
-              "transaction was rolledback",
-              0, 0};
     }
-  } else {
+    return string::npos;
+  }
+
+  /**
+   * Moves the scan position after the first count characters have been
+   * removed from the text
+   */
+  void erase(size_t count) { position -= count; }
+
+private:
+  uint8_t state = 0;
+  size_t position = 0;
+};
+
+SequelBatchOperationResult sqliteImportFile(sqlite3 *db,
+                                            const std::string fileLocation) {
+  std::ifstream sqFile(fileLocation, std::ios::binary);
+
+  if (!sqFile.is_open()) {
     return {SQLiteError,
             "[react-native-quick-sqlite][loadSQLFile] Could not open file", 0,
             0};
   }
-}
\ No newline at end of file
+
+  // Shapes of INSERT statements, only used for this import
+  StatementCache statementCache(DEFAULT_STATEMENT_CACHE_SIZE);
+  const size_t bufferSize = 1 << 20;
+  vector<char> buffer(bufferSize);
+  // Text which has been read but not executed yet
+  string pending;
+  StatementScanner scanner;
+  int affectedRows = 0;
+  int commands = 0;
+  string errorMessage;
+
+  auto execute = [&](string const &sql) -> bool {
+    auto result = executeImportStatement(db, sql, &statementCache);
+    if (result.type == SQLiteError) {
+      sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+      errorMessage = result.errorMessage;
+      return false;
+    }
+    affectedRows += result.rowsAffected;
+    commands++;
+    return true;
+  };
+
+  try {
+    sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
+
+    while (sqFile) {
+      sqFile.read(buffer.data(), bufferSize);
+      pending.append(buffer.data(), sqFile.gcount());
+
+      size_t start = 0;
+      size_t end;
+      while ((end = scanner.next(pending)) != string::npos) {
+        if (!execute(pending.substr(start, end - start))) {
+          return {SQLiteError, errorMessage, 0, commands};
+        }
+        start = end;
+      }
+
+      pending.erase(0, start);
+      scanner.erase(start);
+    }
+
+    // A last statement does not need to be terminated
+    if (pending.find_first_not_of(" \t\r\n") != string::npos &&
+        !execute(pending)) {
+      return {SQLiteError, errorMessage, 0, commands};
+    }
+
+    sqliteExecuteLiteralWithDB(db, "COMMIT");
+    return {SQLiteOk, "", affectedRows, commands};
+  } catch (...) {
+    sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+    return {SQLiteError,
+            "[react-native-quick-sqlite][loadSQLFile] Unexpected error, "
+            "transaction was rolledback",
+            0, 0};
+  }
+}
@@ -4,15 +4,53 @@
 #include "ConnectionPool.h"
 #include "JSIHelper.h"
 #include "sqliteBridge.h"
+#include <functional>
 
 using namespace std;
 using namespace facebook;
 
+/**
+ * A command of a batch, executed once for each of its parameter sets
+ */
 struct QuickQueryArguments {
   string sql;
-  shared_ptr<vector<QuickValue>> params;
+  vector<QuickParameters> params;
 };
 
+/**
+ * Storage of a column of bulk insert parameters
+ */
+enum QuickBulkColumnType {
+  BULK_INT32,
+  BULK_INT64,
+  BULK_FLOAT64,
+  // Values converted one by one, used for strings, ArrayBuffers and plain
+  // arrays of mixed values
+  BULK_VALUES,
+};
+
+/**
+ * Column of bulk insert parameters. Typed array columns are copied from the
+ * array buffer as a whole, values are read from the bytes when they are bound.
+ */
+struct QuickBulkColumn {
+  QuickBulkColumnType type;
+  vector<uint8_t> bytes;
+  vector<QuickValue> values;
+
+  size_t size() const;
+  void bind(sqlite3_stmt *statement, int sqIndex, size_t row) const;
+};
+
+/**
+ * Translates the JS column descriptors of a bulk insert into bulk columns,
+ * returning the row count shared by all columns. Typed array columns are
+ * described by {type, buffer, byteOffset, length}, other columns are plain
+ * arrays. MUST be called in the JavaScript Thread
+ */
+size_t jsiBulkColumnsToQuickColumns(jsi::Runtime &rt, jsi::Array const &columns,
+                                    vector<QuickBulkColumn> *bulkColumns);
+
 /**
  * Local Helper method to translate JSI objects QuickQueryArguments
  * datastructure MUST be called in the JavaScript Thread
@@ -22,10 +60,56 @@ void jsiBatchParametersToQuickArguments(jsi::Runtime &rt,
                                         vector<QuickQueryArguments> *commands);
 
 /**
- * Execute a batch of commands in a exclusive transaction
+ * Error of a single command of a batch which continued on errors. index counts
+ * every parameter set of every command.
+ */
+struct QuickBatchCommandError {
+  size_t index;
+  string message;
+};
+
+/**
+ * Options for committing a long batch in several transactions
+ */
+struct QuickBatchCommitOptions {
+  // Commits after this many commands and parameter sets, zero to commit once
+  size_t commitEvery = 0;
+  // Runs a passive checkpoint after every intermediate commit
+  bool checkpoint = false;
+  // Called with the number of committed and total commands after every commit
+  std::function<void(size_t, size_t)> onProgress;
+};
+
+/**
+ * Execute a batch of commands in a exclusive transaction. If commandResults is
+ * given, the status and rows of every command and parameter set are appended
+ * to it in order.
+ *
+ * If commandErrors is given, every command and parameter set is executed in a
+ * savepoint. Failing commands are rolled back individually and recorded in
+ * commandErrors, while all other commands are committed. Otherwise the whole
+ * batch is rolled back on the first error.
+ *
+ * With commitOptions.commitEvery, the batch is split into several
+ * transactions. An error only rolls back the commands since the last commit.
+ * commands is set to the number of commands and parameter sets, or to the
+ * number of committed ones if the batch fails.
+ */
+SequelBatchOperationResult
+sqliteExecuteBatch(sqlite3 *db, vector<QuickQueryArguments> *commands,
+                   StatementCache *statementCache = nullptr,
+                   vector<QuickStatementResult> *commandResults = nullptr,
+                   vector<QuickBatchCommandError> *commandErrors = nullptr,
+                   QuickBatchCommitOptions const &commitOptions = {});
+
+/**
+ * Executes a single statement once for every row of the bulk columns in a
+ * exclusive transaction. Column i is bound to parameter i + 1.
  */
 SequelBatchOperationResult
-sqliteExecuteBatch(sqlite3 *db, vector<QuickQueryArguments> *commands);
+sqliteExecuteBulk(sqlite3 *db, string const &sql,
+                  vector<QuickBulkColumn> const &columns, size_t rowCount,
+                  StatementCache *statementCache = nullptr);
 
 SequelBatchOperationResult sqliteImportFile(sqlite3 *db,
                                             std::string const file);
\ No newline at end of file
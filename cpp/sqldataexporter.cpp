@@ -0,0 +1,260 @@
+/**
+ * SQL, CSV and NDJSON export implementation
+ */
+#include "sqldataexporter.h"
+#include "sqliteExecute.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+/**
+ * Writes the exported file through a buffer which is flushed whenever it
+ * exceeds its capacity
+ */
+class ExportWriter {
+public:
+  string buffer;
+
+  ExportWriter(string const &path)
+      : file(path, std::ios::binary | std::ios::trunc) {
+    buffer.reserve(capacity + 4096);
+  }
+
+  bool isOpen() const { return file.is_open(); }
+
+  bool flushIfFull() { return buffer.size() < capacity || flush(); }
+
+  bool flush() {
+    file.write(buffer.data(), buffer.size());
+    buffer.clear();
+    return file.good();
+  }
+
+  void close() { file.close(); }
+
+private:
+  static const size_t capacity = 1 << 20;
+  std::ofstream file;
+};
+
+static void appendHex(string &text, const uint8_t *bytes, size_t size) {
+  static const char hex[] = "0123456789abcdef";
+  for (size_t i = 0; i < size; i++) {
+    text.push_back(hex[bytes[i] >> 4]);
+    text.push_back(hex[bytes[i] & 0xf]);
+  }
+}
+
+static void appendQuotedIdentifier(string &text, const char *name) {
+  text.push_back('"');
+  for (const char *c = name; *c != '\0'; c++) {
+    if (*c == '"') {
+      text.push_back('"');
+    }
+    text.push_back(*c);
+  }
+  text.push_back('"');
+}
+
+static void appendCsvField(string &text, const char *value, size_t size,
+                           char delimiter) {
+  bool quote = size == 0;
+  for (size_t i = 0; i < size && !quote; i++) {
+    char c = value[i];
+    quote = c == delimiter || c == '"' || c == '\r' || c == '\n';
+  }
+  if (!quote) {
+    text.append(value, size);
+    return;
+  }
+  text.push_back('"');
+  for (size_t i = 0; i < size; i++) {
+    if (value[i] == '"') {
+      text.push_back('"');
+    }
+    text.push_back(value[i]);
+  }
+  text.push_back('"');
+}
+
+/**
+ * Appends a REAL value so that it is read back as the same REAL value.
+ * Infinity is written as a number which overflows, SQL and JSON have no
+ * literal for it.
+ */
+static void appendReal(string &text, double value, QuickExportFormat format) {
+  if (std::isinf(value)) {
+    if (format == EXPORT_NDJSON) {
+      text.append("null");
+    } else {
+      text.append(value < 0 ? "-1e999" : "1e999");
+    }
+    return;
+  }
+  char number[32];
+  sqlite3_snprintf(sizeof(number), number, "%!.17g", value);
+  text.append(number);
+}
+
+static void appendValue(string &text, sqlite3_stmt *statement, int i,
+                        QuickExportOptions const &options) {
+  switch (sqlite3_column_type(statement, i)) {
+  case SQLITE_INTEGER:
+    text.append(std::to_string(sqlite3_column_int64(statement, i)));
+    break;
+  case SQLITE_FLOAT:
+    appendReal(text, sqlite3_column_double(statement, i), options.format);
+    break;
+  case SQLITE_TEXT: {
+    const char *value = (const char *)sqlite3_column_text(statement, i);
+    size_t size = sqlite3_column_bytes(statement, i);
+    if (options.format == EXPORT_CSV) {
+      appendCsvField(text, value, size, options.delimiter);
+    } else if (options.format == EXPORT_NDJSON) {
+      appendJsonString(text, value, size);
+    } else {
+      text.push_back('\'');
+      for (size_t j = 0; j < size; j++) {
+        if (value[j] == '\'') {
+          text.push_back('\'');
+        }
+        text.push_back(value[j]);
+      }
+      text.push_back('\'');
+    }
+    break;
+  }
+  case SQLITE_BLOB: {
+    const uint8_t *value = (const uint8_t *)sqlite3_column_blob(statement, i);
+    size_t size = sqlite3_column_bytes(statement, i);
+    text.append(options.format == EXPORT_SQL      ? "X'"
+                : options.format == EXPORT_NDJSON ? "\""
+                                                  : "");
+    appendHex(text, value, size);
+    text.append(options.format == EXPORT_SQL      ? "'"
+                : options.format == EXPORT_NDJSON ? "\""
+                                                  : "");
+    break;
+  }
+  default:
+    if (options.format != EXPORT_CSV) {
+      text.append(options.format == EXPORT_SQL ? "NULL" : "null");
+    }
+  }
+}
+
+SequelBatchOperationResult sqliteExportData(sqlite3 *db, string const &query,
+                                            QuickParameters *params,
+                                            string const &fileLocation,
+                                            QuickExportOptions const &options) {
+  if (options.format == EXPORT_SQL && options.table.empty()) {
+    return {SQLiteError,
+            "[react-native-quick-sqlite][exportData] A table name is required "
+            "for SQL exports",
+            0, 0};
+  }
+
+  sqlite3_stmt *statement = NULL;
+  auto status = sqliteOpenCursor(db, query, params, &statement);
+  if (status.type == SQLiteError) {
+    return {SQLiteError, status.errorMessage, 0, 0};
+  }
+
+  ExportWriter writer(fileLocation);
+  if (!writer.isOpen()) {
+    sqlite3_finalize(statement);
+    return {SQLiteError,
+            "[react-native-quick-sqlite][exportData] Could not open file", 0,
+            0};
+  }
+
+  // Column names with their separators, shared by all rows
+  int columnCount = sqlite3_column_count(statement);
+  string rowPrefix;
+  vector<string> keys;
+  if (options.format == EXPORT_SQL) {
+    rowPrefix = "INSERT INTO ";
+    appendQuotedIdentifier(rowPrefix, options.table.c_str());
+    rowPrefix.append(" (");
+    for (int i = 0; i < columnCount; i++) {
+      rowPrefix.append(i > 0 ? ", " : "");
+      appendQuotedIdentifier(rowPrefix, sqlite3_column_name(statement, i));
+    }
+    rowPrefix.append(") VALUES (");
+  } else if (options.format == EXPORT_NDJSON) {
+    for (int i = 0; i < columnCount; i++) {
+      string key = i == 0 ? "{" : ",";
+      const char *name = sqlite3_column_name(statement, i);
+      appendJsonString(key, name, strlen(name));
+      key.push_back(':');
+      keys.push_back(move(key));
+    }
+  } else {
+    for (int i = 0; i < columnCount; i++) {
+      const char *name = sqlite3_column_name(statement, i);
+      if (i > 0) {
+        writer.buffer.push_back(options.delimiter);
+      }
+      appendCsvField(writer.buffer, name, strlen(name), options.delimiter);
+    }
+    writer.buffer.push_back('\n');
+  }
+
+  string error;
+  size_t rows = 0;
+  while (true) {
+    int result = sqlite3_step(statement);
+    if (result == SQLITE_DONE) {
+      break;
+    }
+    if (result != SQLITE_ROW) {
+      error = "[react-native-quick-sqlite] SQL execution error: " +
+              string(sqlite3_errmsg(db));
+      break;
+    }
+
+    string &text = writer.buffer;
+    if (options.format == EXPORT_NDJSON) {
+      for (int i = 0; i < columnCount; i++) {
+        text.append(keys[i]);
+        appendValue(text, statement, i, options);
+      }
+      text.append(columnCount > 0 ? "}\n" : "{}\n");
+    } else {
+      text.append(rowPrefix);
+      for (int i = 0; i < columnCount; i++) {
+        if (i > 0 && options.format == EXPORT_SQL) {
+          text.append(", ");
+        } else if (i > 0) {
+          text.push_back(options.delimiter);
+        }
+        appendValue(text, statement, i, options);
+      }
+      text.append(options.format == EXPORT_SQL ? ");\n" : "\n");
+    }
+
+    if (!writer.flushIfFull()) {
+      error = "[react-native-quick-sqlite][exportData] Could not write file";
+      break;
+    }
+    rows++;
+    if (options.onProgress && rows % options.progressEvery == 0) {
+      options.onProgress(rows);
+    }
+  }
+
+  sqlite3_finalize(statement);
+  if (error.empty() && !writer.flush()) {
+    error = "[react-native-quick-sqlite][exportData] Could not write file";
+  }
+  writer.close();
+
+  if (!error.empty()) {
+    std::remove(fileLocation.c_str());
+    return {SQLiteError, error, 0, (int)rows};
+  }
+  if (options.onProgress && rows % options.progressEvery != 0) {
+    options.onProgress(rows);
+  }
+  return {SQLiteOk, "", 0, (int)rows};
+}
@@ -0,0 +1,48 @@
+/**
+ * Native export of query results into SQL, CSV and NDJSON files
+ */
+#include "JSIHelper.h"
+#include "sqlite3.h"
+#include <functional>
+#include <string>
+
+#ifndef SQLDataExporter_h
+#define SQLDataExporter_h
+
+enum QuickExportFormat {
+  // One INSERT statement per row
+  EXPORT_SQL,
+  // Comma separated values with a header record of the column names
+  EXPORT_CSV,
+  // One JSON object per line
+  EXPORT_NDJSON,
+};
+
+struct QuickExportOptions {
+  QuickExportFormat format = EXPORT_CSV;
+  char delimiter = ',';
+  // Table named in the INSERT statements of SQL exports
+  string table;
+  // Rows between progress reports
+  size_t progressEvery = 10000;
+  // Called with the number of exported rows
+  std::function<void(size_t)> onProgress;
+};
+
+/**
+ * Runs the query and streams its rows into the file, which is replaced if it
+ * exists. Rows are written through a buffer of constant size as they are
+ * stepped, so the result set never needs to fit into memory.
+ *
+ * NULL is written as an empty unquoted CSV field, empty text is quoted. BLOB
+ * values are written as hexadecimal text in CSV and NDJSON files and as blob
+ * literals in SQL files. Invalid UTF-8 in TEXT values is replaced with U+FFFD
+ * in NDJSON files. The file is removed if the export fails. commands is set to
+ * the number of exported rows.
+ */
+SequelBatchOperationResult sqliteExportData(sqlite3 *db, string const &query,
+                                            QuickParameters *params,
+                                            string const &fileLocation,
+                                            QuickExportOptions const &options);
+
+#endif
@@ -0,0 +1,655 @@
+/**
+ * CSV and NDJSON import implementation
+ */
+#include "sqldataimporter.h"
+#include "sqliteExecute.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * Buffered reader over the imported file, counting lines for error messages
+ */
+class ImportReader {
+public:
+  size_t line = 1;
+
+  ImportReader(string const &path)
+      : file(path, std::ios::binary), buffer(1 << 20), position(0), size(0) {}
+
+  bool isOpen() const { return file.is_open(); }
+
+  int peek() {
+    if (position == size && !fill()) {
+      return EOF;
+    }
+    return (unsigned char)buffer[position];
+  }
+
+  int next() {
+    int c = peek();
+    if (c != EOF) {
+      position++;
+      if (c == '\n') {
+        line++;
+      }
+    }
+    return c;
+  }
+
+private:
+  std::ifstream file;
+  vector<char> buffer;
+  size_t position;
+  size_t size;
+
+  bool fill() {
+    file.read(buffer.data(), buffer.size());
+    size = (size_t)file.gcount();
+    position = 0;
+    return size > 0;
+  }
+};
+
+struct ImportField {
+  string value;
+  bool quoted = false;
+};
+
+/**
+ * Reads the next CSV record. Quoted fields may contain delimiters, newlines
+ * and quotes escaped by doubling them. Returns false at the end of the file.
+ */
+static bool readCsvRecord(ImportReader &reader, char delimiter,
+                          vector<ImportField> *fields) {
+  fields->clear();
+  int c = reader.next();
+  if (c == EOF) {
+    return false;
+  }
+
+  ImportField field;
+  while (true) {
+    if (c == '"' && field.value.empty() && !field.quoted) {
+      field.quoted = true;
+      while (true) {
+        c = reader.next();
+        if (c == EOF) {
+          throw std::invalid_argument("Unterminated quoted field");
+        }
+        if (c == '"') {
+          if (reader.peek() != '"') {
+            break;
+          }
+          reader.next();
+        }
+        field.value.push_back((char)c);
+      }
+      c = reader.next();
+      continue;
+    }
+
+    if (c == delimiter) {
+      fields->push_back(move(field));
+      field = ImportField();
+    } else if (c == '\r' && reader.peek() == '\n') {
+      // Handled with the following newline
+    } else if (c == '\n' || c == EOF) {
+      fields->push_back(move(field));
+      return true;
+    } else {
+      field.value.push_back((char)c);
+    }
+    c = reader.next();
+  }
+}
+
+/**
+ * Reads the next line without its line terminator. Returns false at the end
+ * of the file.
+ */
+static bool readLine(ImportReader &reader, string *line) {
+  line->clear();
+  int c = reader.next();
+  if (c == EOF) {
+    return false;
+  }
+  while (c != EOF && c != '\n') {
+    line->push_back((char)c);
+    c = reader.next();
+  }
+  if (!line->empty() && line->back() == '\r') {
+    line->pop_back();
+  }
+  return true;
+}
+
+static void appendUtf8(string &text, uint32_t codePoint) {
+  if (codePoint < 0x80) {
+    text.push_back((char)codePoint);
+  } else if (codePoint < 0x800) {
+    text.push_back((char)(0xC0 | (codePoint >> 6)));
+    text.push_back((char)(0x80 | (codePoint & 0x3F)));
+  } else if (codePoint < 0x10000) {
+    text.push_back((char)(0xE0 | (codePoint >> 12)));
+    text.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+    text.push_back((char)(0x80 | (codePoint & 0x3F)));
+  } else {
+    text.push_back((char)(0xF0 | (codePoint >> 18)));
+    text.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+    text.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+    text.push_back((char)(0x80 | (codePoint & 0x3F)));
+  }
+}
+
+/**
+ * Parser for the flat JSON objects of NDJSON lines. Nested objects and arrays
+ * are returned as their JSON text.
+ */
+class JsonLineParser {
+public:
+  JsonLineParser(string const &line) : line(line), i(0) {}
+
+  void parseObject(vector<pair<string, QuickValue>> *fields) {
+    fields->clear();
+    skipWhitespace();
+    expect('{');
+    skipWhitespace();
+    if (peek() == '}') {
+      i++;
+      return;
+    }
+    while (true) {
+      skipWhitespace();
+      expect('"');
+      string key = parseString();
+      skipWhitespace();
+      expect(':');
+      skipWhitespace();
+      fields->emplace_back(move(key), parseValue());
+      skipWhitespace();
+      if (peek() == ',') {
+        i++;
+      } else {
+        expect('}');
+        break;
+      }
+    }
+    skipWhitespace();
+    if (i < line.length()) {
+      throw std::invalid_argument("Unexpected content after JSON object");
+    }
+  }
+
+private:
+  string const &line;
+  size_t i;
+
+  char peek() const { return i < line.length() ? line[i] : '\0'; }
+
+  void expect(char c) {
+    if (peek() != c) {
+      throw std::invalid_argument(string("Expected '") + c + "' in JSON");
+    }
+    i++;
+  }
+
+  void skipWhitespace() {
+    while (i < line.length() && (line[i] == ' ' || line[i] == '\t' ||
+                                 line[i] == '\r' || line[i] == '\n')) {
+      i++;
+    }
+  }
+
+  uint32_t parseHex4() {
+    if (i + 4 > line.length()) {
+      throw std::invalid_argument("Invalid JSON escape");
+    }
+    uint32_t value = 0;
+    for (size_t end = i + 4; i < end; i++) {
+      char c = line[i];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        throw std::invalid_argument("Invalid JSON escape");
+      }
+    }
+    return value;
+  }
+
+  // Parses a string after its opening quote
+  string parseString() {
+    string text;
+    while (true) {
+      if (i >= line.length()) {
+        throw std::invalid_argument("Unterminated JSON string");
+      }
+      char c = line[i++];
+      if (c == '"') {
+        return text;
+      }
+      if (c != '\\') {
+        text.push_back(c);
+        continue;
+      }
+      char escape = peek();
+      i++;
+      switch (escape) {
+      case 'b':
+        text.push_back('\b');
+        break;
+      case 'f':
+        text.push_back('\f');
+        break;
+      case 'n':
+        text.push_back('\n');
+        break;
+      case 'r':
+        text.push_back('\r');
+        break;
+      case 't':
+        text.push_back('\t');
+        break;
+      case 'u': {
+        uint32_t codePoint = parseHex4();
+        if (codePoint >= 0xD800 && codePoint < 0xDC00 && peek() == '\\' &&
+            i + 1 < line.length() && line[i + 1] == 'u') {
+          i += 2;
+          uint32_t low = parseHex4();
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+        appendUtf8(text, codePoint);
+        break;
+      }
+      case '"':
+      case '\\':
+      case '/':
+        text.push_back(escape);
+        break;
+      default:
+        throw std::invalid_argument("Invalid JSON escape");
+      }
+    }
+  }
+
+  // Skips a nested object or array, returning its JSON text
+  string parseNested() {
+    size_t start = i;
+    int depth = 0;
+    do {
+      if (i >= line.length()) {
+        throw std::invalid_argument("Unterminated JSON value");
+      }
+      char c = line[i++];
+      if (c == '"') {
+        parseString();
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        depth--;
+      }
+    } while (depth > 0);
+    return line.substr(start, i - start);
+  }
+
+  QuickValue parseValue() {
+    char c = peek();
+    if (c == '"') {
+      i++;
+      return createTextQuickValue(parseString());
+    }
+    if (c == '{' || c == '[') {
+      return createTextQuickValue(parseNested());
+    }
+    if (line.compare(i, 4, "null") == 0) {
+      i += 4;
+      return createNullQuickValue();
+    }
+    if (line.compare(i, 4, "true") == 0) {
+      i += 4;
+      return createBooleanQuickValue(true);
+    }
+    if (line.compare(i, 5, "false") == 0) {
+      i += 5;
+      return createBooleanQuickValue(false);
+    }
+
+    size_t start = i;
+    bool isReal = false;
+    while (i < line.length() &&
+           (isdigit((unsigned char)line[i]) || line[i] == '-' ||
+            line[i] == '+' || line[i] == '.' || line[i] == 'e' ||
+            line[i] == 'E')) {
+      isReal = isReal || line[i] == '.' || line[i] == 'e' || line[i] == 'E';
+      i++;
+    }
+    if (i == start) {
+      throw std::invalid_argument("Invalid JSON value");
+    }
+    string number = line.substr(start, i - start);
+    if (!isReal) {
+      errno = 0;
+      long long integer = strtoll(number.c_str(), nullptr, 10);
+      if (errno != ERANGE) {
+        return createInt64QuickValue(integer);
+      }
+    }
+    return createDoubleQuickValue(strtod(number.c_str(), nullptr));
+  }
+};
+
+/**
+ * Parses text which consists of a decimal integer or real number, ignoring
+ * surrounding spaces like SQLite does
+ */
+static bool parseNumber(string const &text, long long *integer, double *real,
+                        bool *isInteger) {
+  const char *start = text.c_str();
+  const char *end = start + text.length();
+  while (start < end && isspace((unsigned char)*start)) {
+    start++;
+  }
+  while (end > start && isspace((unsigned char)end[-1])) {
+    end--;
+  }
+  if (start == end) {
+    return false;
+  }
+  for (const char *c = start; c < end; c++) {
+    // Rejects hex numbers, infinity and NaN, which strtod would accept
+    if (!isdigit((unsigned char)*c) && *c != '-' && *c != '+' && *c != '.' &&
+        *c != 'e' && *c != 'E') {
+      return false;
+    }
+  }
+
+  string number(start, end);
+  char *parsed;
+  errno = 0;
+  *integer = strtoll(number.c_str(), &parsed, 10);
+  if (*parsed == '\0' && errno != ERANGE) {
+    *isInteger = true;
+    return true;
+  }
+  *real = strtod(number.c_str(), &parsed);
+  *isInteger = false;
+  return *parsed == '\0';
+}
+
+/**
+ * Converts a value according to the affinity of its column
+ */
+static QuickValue applyAffinity(QuickValue value,
+                                QuickImportAffinity affinity) {
+  if (affinity == AFFINITY_NONE) {
+    return value;
+  }
+
+  if (affinity == AFFINITY_TEXT) {
+    char text[32];
+    switch (value.dataType()) {
+    case INT64:
+      return createTextQuickValue(std::to_string(value.int64Value()));
+    case DOUBLE:
+      sqlite3_snprintf(sizeof(text), text, "%!.15g", value.doubleValue());
+      return createTextQuickValue(text);
+    default:
+      return value;
+    }
+  }
+
+  if (value.dataType() != TEXT) {
+    return value;
+  }
+  long long integer;
+  double real;
+  bool isInteger;
+  if (!parseNumber(value.textValue(), &integer, &real, &isInteger)) {
+    return value;
+  }
+  if (affinity == AFFINITY_REAL) {
+    return createDoubleQuickValue(isInteger ? (double)integer : real);
+  }
+  if (!isInteger && real == std::floor(real) && std::fabs(real) < 9.2e18) {
+    // Like SQLite, reals without fractional part become integers
+    return createInt64QuickValue((long long)real);
+  }
+  return isInteger ? createInt64QuickValue(integer)
+                   : createDoubleQuickValue(real);
+}
+
+static string quoteIdentifier(string const &name) {
+  string quoted = "\"";
+  for (char c : name) {
+    if (c == '"') {
+      quoted.push_back('"');
+    }
+    quoted.push_back(c);
+  }
+  quoted.push_back('"');
+  return quoted;
+}
+
+SequelBatchOperationResult sqliteImportData(sqlite3 *db,
+                                            string const &fileLocation,
+                                            string const &table,
+                                            QuickImportOptions const &options) {
+  ImportReader reader(fileLocation);
+  if (!reader.isOpen()) {
+    return {SQLiteError,
+            "[react-native-quick-sqlite][importData] Could not open file", 0,
+            0};
+  }
+
+  vector<ImportField> record;
+  vector<pair<string, QuickValue>> object;
+  string line;
+  bool hasPendingObject = false;
+  // Parameter index of every source field, by CSV field index or JSON key
+  vector<int> fieldParameters;
+  std::unordered_map<string, int> keyParameters;
+  vector<string> columns;
+  vector<QuickImportAffinity> affinities;
+  sqlite3_stmt *statement = NULL;
+  size_t rows = 0;
+  int affectedRows = 0;
+  // Rows which stay in the table if the import fails
+  size_t committedRows = 0;
+  int committedChanges = 0;
+  size_t recordLine = 1;
+  bool inTransaction = false;
+
+  auto fail = [&](string const &message) -> SequelBatchOperationResult {
+    if (inTransaction) {
+      sqliteExecuteLiteralWithDB(db, "ROLLBACK");
+    }
+    sqlite3_finalize(statement);
+    return {SQLiteError,
+            "[react-native-quick-sqlite][importData] " + message + " on line " +
+                std::to_string(recordLine),
+            committedChanges, (int)committedRows};
+  };
+  auto commit = [&]() -> bool {
+    if (sqliteExecuteLiteralWithDB(db, "COMMIT").type == SQLiteError) {
+      return false;
+    }
+    inTransaction = false;
+    committedRows = rows;
+    committedChanges = affectedRows;
+    return true;
+  };
+
+  try {
+    // Read the source fields from the CSV header or the first JSON object
+    vector<string> sourceFields;
+    if (options.format == IMPORT_CSV) {
+      if (!readCsvRecord(reader, options.delimiter, &record)) {
+        return {SQLiteError, "[react-native-quick-sqlite][importData] File is empty", 0, 0};
+      }
+      for (auto &field : record) {
+        sourceFields.push_back(field.value);
+      }
+      if (!sourceFields.empty() &&
+          sourceFields[0].compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        // Byte order mark
+        sourceFields[0].erase(0, 3);
+      }
+    } else {
+      while (readLine(reader, &line)) {
+        recordLine = reader.line - 1;
+        if (line.find_first_not_of(" \t") != string::npos) {
+          JsonLineParser(line).parseObject(&object);
+          hasPendingObject = true;
+          break;
+        }
+      }
+      for (auto &field : object) {
+        sourceFields.push_back(field.first);
+      }
+    }
+
+    vector<pair<string, string>> mapping = options.columns;
+    if (mapping.empty()) {
+      for (auto &field : sourceFields) {
+        mapping.emplace_back(field, field);
+      }
+    }
+    if (mapping.empty()) {
+      return {SQLiteError, "[react-native-quick-sqlite][importData] No columns to import", 0, 0};
+    }
+
+    std::unordered_map<string, int> mappedFields;
+    for (size_t i = 0; i < mapping.size(); i++) {
+      mappedFields[mapping[i].first] = (int)i + 1;
+      columns.push_back(mapping[i].second);
+      auto affinity = options.affinities.find(mapping[i].second);
+      affinities.push_back(affinity != options.affinities.end()
+                               ? affinity->second
+                               : AFFINITY_NONE);
+    }
+    if (options.format == IMPORT_CSV) {
+      for (auto &field : sourceFields) {
+        auto parameter = mappedFields.find(field);
+        fieldParameters.push_back(
+            parameter != mappedFields.end() ? parameter->second : 0);
+      }
+    } else {
+      keyParameters = move(mappedFields);
+    }
+
+    string sql = "INSERT INTO " + quoteIdentifier(table) + " (";
+    string values;
+    for (size_t i = 0; i < columns.size(); i++) {
+      sql += (i > 0 ? ", " : "") + quoteIdentifier(columns[i]);
+      values += i > 0 ? ", ?" : "?";
+    }
+    sql += ") VALUES (" + values + ")";
+
+    if (sqlite3_prepare_v2(db, sql.c_str(), (int)sql.length(), &statement,
+                           NULL) != SQLITE_OK) {
+      return {SQLiteError,
+              "[react-native-quick-sqlite][importData] " +
+                  string(sqlite3_errmsg(db)),
+              0, 0};
+    }
+
+    // Without a transaction every row would be committed on its own
+    auto begin = sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
+    if (begin.type == SQLiteError) {
+      return fail(sqlite3_errmsg(db));
+    }
+    inTransaction = true;
+    size_t uncommitted = 0;
+
+    while (true) {
+      if (options.format == IMPORT_CSV) {
+        recordLine = reader.line;
+        if (!readCsvRecord(reader, options.delimiter, &record)) {
+          break;
+        }
+        if (record.size() == 1 && record[0].value.empty() &&
+            !record[0].quoted) {
+          // Blank line
+          continue;
+        }
+        for (size_t i = 0; i < record.size() && i < fieldParameters.size();
+             i++) {
+          int parameter = fieldParameters[i];
+          if (parameter == 0) {
+            continue;
+          }
+          ImportField &field = record[i];
+          QuickValue value = field.value.empty() && !field.quoted
+                                 ? createNullQuickValue()
+                                 : createTextQuickValue(move(field.value));
+          bindValue(statement, parameter,
+                    applyAffinity(move(value), affinities[parameter - 1]));
+        }
+      } else {
+        if (!hasPendingObject) {
+          if (!readLine(reader, &line)) {
+            break;
+          }
+          recordLine = reader.line - 1;
+          if (line.find_first_not_of(" \t") == string::npos) {
+            continue;
+          }
+          JsonLineParser(line).parseObject(&object);
+        }
+        hasPendingObject = false;
+        for (auto &field : object) {
+          auto parameter = keyParameters.find(field.first);
+          if (parameter != keyParameters.end()) {
+            bindValue(statement, parameter->second,
+                      applyAffinity(move(field.second),
+                                    affinities[parameter->second - 1]));
+          }
+        }
+      }
+
+      if (sqlite3_step(statement) != SQLITE_DONE) {
+        return fail(sqlite3_errmsg(db));
+      }
+      affectedRows += sqlite3_changes(db);
+      sqlite3_reset(statement);
+      // Fields missing from the next record are NULL
+      sqlite3_clear_bindings(statement);
+      rows++;
+
+      if (++uncommitted >= options.commitEvery) {
+        if (!commit()) {
+          return fail(sqlite3_errmsg(db));
+        }
+        uncommitted = 0;
+        if (options.onProgress) {
+          options.onProgress(rows);
+        }
+        begin = sqliteExecuteLiteralWithDB(db, "BEGIN EXCLUSIVE TRANSACTION");
+        if (begin.type == SQLiteError) {
+          return fail(sqlite3_errmsg(db));
+        }
+        inTransaction = true;
+      }
+    }
+
+    if (!commit()) {
+      return fail(sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(statement);
+    if (options.onProgress) {
+      options.onProgress(rows);
+    }
+    return {SQLiteOk, "", affectedRows, (int)rows};
+  } catch (std::exception &exc) {
+    return fail(exc.what());
+  }
+}
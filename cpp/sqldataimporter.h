@@ -0,0 +1,66 @@
+/**
+ * Native import of CSV and NDJSON files into a table
+ */
+#include "JSIHelper.h"
+#include "sqlite3.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef SQLDataImporter_h
+#define SQLDataImporter_h
+
+enum QuickImportFormat {
+  // Comma separated values, the first record names the fields
+  IMPORT_CSV,
+  // One JSON object per line
+  IMPORT_NDJSON,
+};
+
+/**
+ * Conversion of imported text values before they are bound, following the
+ * rules of SQLite column affinities
+ */
+enum QuickImportAffinity {
+  // Text values are bound as text, the table converts them
+  AFFINITY_NONE,
+  AFFINITY_TEXT,
+  AFFINITY_INTEGER,
+  AFFINITY_REAL,
+  AFFINITY_NUMERIC,
+};
+
+struct QuickImportOptions {
+  QuickImportFormat format = IMPORT_CSV;
+  char delimiter = ',';
+  // Pairs of source field and table column. All fields of the CSV header or
+  // of the first NDJSON object are imported into columns of the same name if
+  // empty.
+  vector<pair<string, string>> columns;
+  // Affinity by table column
+  std::unordered_map<string, QuickImportAffinity> affinities;
+  // Rows per transaction
+  size_t commitEvery = 10000;
+  // Called with the number of imported rows after every commit
+  std::function<void(size_t)> onProgress;
+};
+
+/**
+ * Streams a CSV or NDJSON file into the table with a single prepared INSERT
+ * statement, committing every options.commitEvery rows. Empty unquoted CSV
+ * fields and missing NDJSON keys are imported as NULL. Nested JSON values are
+ * imported as JSON text.
+ *
+ * An error rolls back the rows since the last commit, rows committed before
+ * stay in the table. commands is set to the number of imported rows, or of
+ * committed rows if the import fails. Fails without importing anything if a
+ * transaction is already open on the connection.
+ */
+SequelBatchOperationResult sqliteImportData(sqlite3 *db,
+                                            string const &fileLocation,
+                                            string const &table,
+                                            QuickImportOptions const &options);
+
+#endif
@@ -52,7 +52,8 @@ sqliteOpenDb(string const dbName, string const docPath,
                                          const char *, sqlite3_int64),
              void (*onTransactionFinalizedCallback)(
                  const TransactionCallbackPayload *event),
-             uint32_t numReadConnections) {
+             uint32_t numReadConnections, size_t statementCacheSize,
+             double readIdleTimeoutMs) {
   if (dbMap.count(dbName) == 1) {
     return SQLiteOPResult{
         .type = SQLiteError,
@@ -62,7 +63,8 @@ sqliteOpenDb(string const dbName, string const docPath,
 
   try {
     // Open the database
-    dbMap[dbName] = new ConnectionPool(dbName, docPath, numReadConnections);
+    dbMap[dbName] = new ConnectionPool(dbName, docPath, numReadConnections,
+                                        statementCacheSize, readIdleTimeoutMs);
     dbMap[dbName]->setOnContextAvailable(contextAvailableCallback);
     dbMap[dbName]->setTableUpdateHandler(updateTableCallback);
     dbMap[dbName]->setTransactionFinalizerHandler(onTransactionFinalizedCallback);
@@ -115,7 +117,7 @@ void sqliteCloseAll() {
 
 SQLiteOPResult sqliteQueueInContext(std::string dbName,
                                     ConnectionLockId const contextId,
-                                    std::function<void(sqlite3 *)> task) {
+                                    std::function<void(ConnectionState *)> task) {
   if (dbMap.count(dbName) == 0) {
     return generateNotOpenResult(dbName);
   }
@@ -137,23 +139,32 @@ void sqliteReleaseLock(std::string const dbName,
 
 SQLiteOPResult sqliteRequestLock(std::string const dbName,
                                  ConnectionLockId const contextId,
-                                 ConcurrentLockType lockType) {
+                                 ConcurrentLockType lockType,
+                                 LockPriority priority) {
   if (dbMap.count(dbName) == 0) {
     return generateNotOpenResult(dbName);
   }
 
   ConnectionPool *connection = dbMap[dbName];
 
-  switch (lockType) {
-  case ConcurrentLockType::ReadLock:
-    connection->readLock(contextId);
-    break;
-  case ConcurrentLockType::WriteLock:
-    connection->writeLock(contextId);
-    break;
-
-  default:
-    break;
+  try {
+    switch (lockType) {
+    case ConcurrentLockType::ReadLock:
+      // Can fail to open a read connection
+      connection->readLock(contextId, priority);
+      break;
+    case ConcurrentLockType::WriteLock:
+      connection->writeLock(contextId, priority);
+      break;
+
+    default:
+      break;
+    }
+  } catch (const std::exception &e) {
+    return SQLiteOPResult{
+        .type = SQLiteError,
+        .errorMessage = e.what(),
+    };
   }
 
   return SQLiteOPResult{
@@ -182,6 +193,20 @@ SQLiteOPResult sqliteDetachDb(string const mainDBName, string const alias) {
   return connection->detachDatabase(alias);
 }
 
+SQLiteOPResult sqliteGetStatementCacheStats(std::string const dbName,
+                                            StatementCacheStats *stats) {
+  if (dbMap.count(dbName) == 0) {
+    return generateNotOpenResult(dbName);
+  }
+
+  ConnectionPool *connection = dbMap[dbName];
+  *stats = connection->getStatementCacheStats();
+
+  return SQLiteOPResult{
+      .type = SQLiteOk,
+  };
+}
+
 SQLiteOPResult sqliteRemoveDb(string const dbName, string const docPath) {
   if (dbMap.count(dbName) == 1) {
     SQLiteOPResult closeResult = sqliteCloseDb(dbName);
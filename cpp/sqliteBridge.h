@@ -32,7 +32,8 @@ sqliteOpenDb(std::string const dbName, std::string const docPath,
                                          const char *, sqlite3_int64),
              void (*onTransactionFinalizedCallback)(
                  const TransactionCallbackPayload *event),
-             uint32_t numReadConnections);
+             uint32_t numReadConnections, size_t statementCacheSize,
+             double readIdleTimeoutMs = DEFAULT_READ_IDLE_TIMEOUT_MS);
 
 std::future<void> sqliteRefreshSchema(const std::string& dbName);
 
@@ -49,11 +50,12 @@ SQLiteOPResult sqliteRemoveDb(string const dbName, string const docPath);
  */
 SQLiteOPResult sqliteRequestLock(std::string const dbName,
                                  ConnectionLockId const contextId,
-                                 ConcurrentLockType lockType);
+                                 ConcurrentLockType lockType,
+                                 LockPriority priority = NormalPriority);
 
 SQLiteOPResult sqliteQueueInContext(std::string dbName,
                                     ConnectionLockId const contextId,
-                                    std::function<void(sqlite3 *)>);
+                                    std::function<void(ConnectionState *)>);
 
 void sqliteReleaseLock(std::string const dbName,
                        ConnectionLockId const contextId);
@@ -64,4 +66,7 @@ SQLiteOPResult sqliteAttachDb(string const mainDBName, string const docPath,
 
 SQLiteOPResult sqliteDetachDb(string const mainDBName, string const alias);
 
+SQLiteOPResult sqliteGetStatementCacheStats(std::string const dbName,
+                                            StatementCacheStats *stats);
+
 #endif
\ No newline at end of file
@@ -1,190 +1,533 @@
 #include "sqliteExecute.h"
+#include <algorithm>
+#include <cctype>
+
+void bindValue(sqlite3_stmt *statement, int sqIndex, QuickValue const &value) {
+  switch (value.dataType()) {
+  case INT64:
+    sqlite3_bind_int64(statement, sqIndex, value.int64Value());
+    break;
+  case DOUBLE:
+    sqlite3_bind_double(statement, sqIndex, value.doubleValue());
+    break;
+  case TEXT: {
+    string const &text = value.textValue();
+    sqlite3_bind_text(statement, sqIndex, text.c_str(), text.length(),
+                      SQLITE_TRANSIENT);
+    break;
+  }
+  case ARRAY_BUFFER: {
+    QuickBlob const &blob = value.blobValue();
+    sqlite3_bind_blob(statement, sqIndex, blob.data.get(), blob.size,
+                      SQLITE_STATIC);
+    break;
+  }
+  default:
+    sqlite3_bind_null(statement, sqIndex);
+    break;
+  }
+}
+
+void bindStatement(sqlite3_stmt *statement, QuickParameters *params,
+                   size_t offset, StatementCache *statementCache) {
+  std::vector<QuickValue> &values = params->values;
+
+  if (!params->names.empty()) {
+    // Every statement binds the names it declares, names which are not used
+    // by the statement are ignored
+    for (size_t ii = 0; ii < values.size(); ii++) {
+      int sqIndex = statementCache != nullptr
+                        ? statementCache->parameterIndex(statement,
+                                                         params->names[ii])
+                        : findParameterIndex(statement, params->names[ii]);
+      if (sqIndex > 0) {
+        bindValue(statement, sqIndex, values[ii]);
+      }
+    }
+    return;
+  }
 
-void bindStatement(sqlite3_stmt *statement, vector<QuickValue> *values) {
-  size_t size = values->size();
-  if (size <= 0) {
+  if (values.size() <= offset) {
     return;
   }
+  // Statements of a multi-statement query only bind the parameters they
+  // declare
+  size_t size = std::min(values.size() - offset,
+                         (size_t)sqlite3_bind_parameter_count(statement));
 
   for (int ii = 0; ii < size; ii++) {
-    int sqIndex = ii + 1;
-    const QuickValue& value = values->at(ii);
-    QuickDataType dataType = value.dataType;
-    if (dataType == NULL_VALUE) {
-      sqlite3_bind_null(statement, sqIndex);
-    } else if (dataType == BOOLEAN) {
-      sqlite3_bind_int(statement, sqIndex, value.booleanValue);
-    } else if (dataType == INTEGER) {
-      sqlite3_bind_int(statement, sqIndex, (int)value.doubleOrIntValue);
-    } else if (dataType == DOUBLE) {
-      sqlite3_bind_double(statement, sqIndex, value.doubleOrIntValue);
-    } else if (dataType == INT64) {
-      sqlite3_bind_int64(statement, sqIndex, value.int64Value);
-    } else if (dataType == TEXT) {
-      sqlite3_bind_text(statement, sqIndex, value.textValue.c_str(),
-                        value.textValue.length(), SQLITE_TRANSIENT);
-    } else if (dataType == ARRAY_BUFFER) {
-      sqlite3_bind_blob(statement, sqIndex, value.arrayBuffer.data(),
-                        value.arrayBuffer.size(), SQLITE_STATIC);
-    }
+    bindValue(statement, ii + 1, values[offset + ii]);
   }
 }
 
-SQLiteOPResult
-sqliteExecuteWithDB(sqlite3 *db, std::string const &query,
-                    std::vector<QuickValue> *params,
-                    std::vector<map<std::string, QuickValue>> *results,
-                    std::vector<QuickColumnMetadata> *metadata) {
-  sqlite3_stmt *statement;
+void sqliteReadColumns(sqlite3_stmt *statement, QuickResultSet *results) {
+  int count = sqlite3_column_count(statement);
+  results->columns.resize(count);
+  for (int i = 0; i < count; i++) {
+    QuickColumn &column = results->columns[i];
+    column.columnName = sqlite3_column_name(statement, i);
+    column.columnIndex = i;
+    const char *tp = sqlite3_column_decltype(statement, i);
+    column.columnDeclaredType = tp != NULL ? tp : "UNKNOWN";
+  }
+}
 
-  int statementStatus =
-      sqlite3_prepare_v2(db, query.c_str(), -1, &statement, NULL);
+void sqliteReadRow(sqlite3_stmt *statement, QuickResultSet *results) {
+  if (results->rowCount == 0) {
+    // Columns are only known once the statement has been stepped, the
+    // statement could have been re-prepared after a schema change
+    sqliteReadColumns(statement, results);
+  }
 
-  if (statementStatus ==
-      SQLITE_OK) // statemnet is correct, bind the passed parameters
-  {
-    bindStatement(statement, params);
-  } else {
-    const char *message = sqlite3_errmsg(db);
-    return SQLiteOPResult{
-        .type = SQLiteError,
-        .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
-                        string(message),
-        .rowsAffected = 0};
+  int count = (int)results->columns.size();
+  for (int i = 0; i < count; i++) {
+    QuickColumn &column = results->columns[i];
+
+    switch (sqlite3_column_type(statement, i)) {
+
+    case SQLITE_INTEGER: {
+      // Read the full 64 bit value, the conversion to a JS number or BigInt
+      // happens on the JS thread depending on the integer mode
+      column.appendInteger(sqlite3_column_int64(statement, i));
+      break;
+    }
+
+    case SQLITE_FLOAT: {
+      column.appendDouble(sqlite3_column_double(statement, i));
+      break;
+    }
+
+    case SQLITE_TEXT: {
+      const uint8_t *column_value = sqlite3_column_text(statement, i);
+      // Specify length too; in case string contains NULL in the middle
+      // (which SQLite supports!)
+      int byteLen = sqlite3_column_bytes(statement, i);
+      column.appendBytes(TEXT, results->arena.copy(column_value, byteLen),
+                         byteLen);
+      break;
+    }
+
+    case SQLITE_BLOB: {
+      const void *blob = sqlite3_column_blob(statement, i);
+      int blob_size = sqlite3_column_bytes(statement, i);
+      column.appendBytes(
+          ARRAY_BUFFER,
+          results->arena.copy(static_cast<const uint8_t *>(blob), blob_size),
+          blob_size);
+      break;
+    }
+
+    case SQLITE_NULL:
+      // Intentionally left blank to switch to default case
+    default:
+      column.appendNull();
+      break;
+    }
   }
+  results->rowCount++;
+}
 
-  bool isConsuming = true;
-  bool isFailed = false;
+/**
+ * Returns true if only whitespace remains after the tail pointer of a
+ * prepared statement
+ */
+static bool isEmptyTail(const char *tail, const char *end) {
+  while (tail < end && isspace((unsigned char)*tail)) {
+    tail++;
+  }
+  return tail >= end;
+}
 
-  int result, i, count, column_type;
-  std::string column_name, column_declared_type;
-  std::map<string, QuickValue> row;
+/**
+ * Prepares, binds and steps every statement in the query. Parameters are
+ * consumed in order, each statement binds as many as it declares.
+ * Rows are read into the result set returned by nextResults, which is called
+ * once for every statement.
+ */
+static SQLiteOPResult
+sqliteExecuteStatements(sqlite3 *db, std::string const &query,
+                        QuickParameters *params,
+                        StatementCache *statementCache,
+                        std::function<QuickResultSet *()> const &nextResults,
+                        std::vector<QuickStatementResult> *statementResults) {
+  const char *sql = query.c_str();
+  const char *end = sql + query.length();
+  size_t paramOffset = 0;
+  bool isFirst = true;
+  SQLiteOPResult status = {.type = SQLiteOk, .rowsAffected = 0};
+
+  while (sql < end) {
+    sqlite3_stmt *statement = NULL;
+    const char *tail = NULL;
+    int statementStatus;
+
+    // Only queries consisting of a single statement are cached, the cache is
+    // keyed by the full query text
+    bool useCache = isFirst && statementCache != nullptr;
+    if (useCache) {
+      statementStatus = statementCache->prepare(db, query, &statement, &tail);
+    } else {
+      statementStatus = sqlite3_prepare_v2(db, sql, (int)(end - sql),
+                                           &statement, &tail);
+    }
+    isFirst = false;
+
+    if (statementStatus != SQLITE_OK) {
+      const char *message = sqlite3_errmsg(db);
+      return SQLiteOPResult{
+          .type = SQLiteError,
+          .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
+                          string(message),
+          .rowsAffected = 0};
+    }
 
-  while (isConsuming) {
-    result = sqlite3_step(statement);
+    bool isLast = isEmptyTail(tail, end);
+    sql = tail;
+    if (statement == NULL) {
+      // Whitespace or a comment
+      continue;
+    }
 
-    switch (result) {
-    case SQLITE_ROW:
-      if (results == NULL) {
-        break;
-      }
+    // Parameter indexes are only cached for statements owned by the cache
+    bindStatement(statement, params, paramOffset,
+                  useCache && isLast ? statementCache : nullptr);
+    paramOffset += sqlite3_bind_parameter_count(statement);
 
-      i = 0;
-      row = std::map<std::string, QuickValue>();
-      count = sqlite3_column_count(statement);
-
-      while (i < count) {
-        column_type = sqlite3_column_type(statement, i);
-        column_name = sqlite3_column_name(statement, i);
-
-        switch (column_type) {
-
-        case SQLITE_INTEGER: {
-          /**
-           * It's not possible to send a int64_t in a jsi::Value because JS
-           * cannot represent the whole number range. Instead, we're sending a
-           * double, which can represent all integers up to 53 bits long, which
-           * is more than what was there before (a 32-bit int).
-           *
-           * See https://github.com/margelo/react-native-quick-sqlite/issues/16
-           * for more context.
-           */
-          double column_value = sqlite3_column_double(statement, i);
-          row[column_name] = createIntegerQuickValue(column_value);
-          break;
-        }
+    QuickResultSet *results = nextResults();
+    bool isConsuming = true;
+    bool isFailed = false;
 
-        case SQLITE_FLOAT: {
-          double column_value = sqlite3_column_double(statement, i);
-          row[column_name] = createDoubleQuickValue(column_value);
-          break;
-        }
+    while (isConsuming) {
+      int result = sqlite3_step(statement);
 
-        case SQLITE_TEXT: {
-          const char *column_value =
-              reinterpret_cast<const char *>(sqlite3_column_text(statement, i));
-          int byteLen = sqlite3_column_bytes(statement, i);
-          // Specify length too; in case string contains NULL in the middle
-          // (which SQLite supports!)
-          row[column_name] =
-              createTextQuickValue(std::string(column_value, byteLen));
+      switch (result) {
+      case SQLITE_ROW:
+        if (results == NULL) {
           break;
         }
 
-        case SQLITE_BLOB: {
-          int blob_size = sqlite3_column_bytes(statement, i);
-          const void *blob = sqlite3_column_blob(statement, i);
-          row[column_name] = createArrayBufferQuickValueByCopying(static_cast<const uint8_t*>(blob), blob_size);
-          break;
+        sqliteReadRow(statement, results);
+        break;
+      case SQLITE_DONE:
+        if (results != NULL && results->rowCount == 0) {
+          sqliteReadColumns(statement, results);
         }
+        isConsuming = false;
+        break;
 
-        case SQLITE_NULL:
-          // Intentionally left blank to switch to default case
-        default:
-          row[column_name] = createNullQuickValue();
-          break;
-        }
-        i++;
+      default:
+        isFailed = true;
+        isConsuming = false;
       }
-      results->push_back(move(row));
-      break;
-    case SQLITE_DONE:
-      if (metadata != NULL) {
-        i = 0;
-        count = sqlite3_column_count(statement);
-        while (i < count) {
-          column_name = sqlite3_column_name(statement, i);
-          const char *tp = sqlite3_column_decltype(statement, i);
-          column_declared_type = tp != NULL ? tp : "UNKNOWN";
-          QuickColumnMetadata meta = {
-              .columnName = column_name,
-              .columnIndex = i,
-              .columnDeclaredType = column_declared_type,
-          };
-          metadata->push_back(meta);
-          i++;
+    }
+
+    if (useCache && isLast) {
+      statementCache->release(query, statement);
+    } else {
+      sqlite3_finalize(statement);
+    }
+
+    if (isFailed) {
+      const char *message = sqlite3_errmsg(db);
+      return SQLiteOPResult{
+          .type = SQLiteError,
+          .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
+                          std::string(message),
+          .rowsAffected = 0,
+          .insertId = 0};
+    }
+
+    status = SQLiteOPResult{.type = SQLiteOk,
+                            .rowsAffected = sqlite3_changes(db),
+                            .insertId = sqlite3_last_insert_rowid(db)};
+    if (statementResults != nullptr) {
+      statementResults->back().status = status;
+    }
+  }
+
+  return status;
+}
+
+SQLiteOPResult sqliteExecuteWithDB(sqlite3 *db, std::string const &query,
+                                   QuickParameters *params,
+                                   QuickResultSet *results,
+                                   StatementCache *statementCache) {
+  return sqliteExecuteStatements(
+      db, query, params, statementCache,
+      [results]() -> QuickResultSet * {
+        if (results != NULL) {
+          // Only the rows of the last statement are returned
+          *results = QuickResultSet();
         }
+        return results;
+      },
+      nullptr);
+}
+
+SQLiteOPResult
+sqliteExecuteAllWithDB(sqlite3 *db, std::string const &query,
+                       QuickParameters *params,
+                       std::vector<QuickStatementResult> *statementResults,
+                       StatementCache *statementCache) {
+  return sqliteExecuteStatements(
+      db, query, params, statementCache,
+      [statementResults]() -> QuickResultSet * {
+        statementResults->push_back(QuickStatementResult{
+            .results = make_shared<QuickResultSet>()});
+        return statementResults->back().results.get();
+      },
+      statementResults);
+}
+
+/**
+ * Prepares a query consisting of a single statement. statement is set to NULL
+ * if the query has multiple statements or none.
+ */
+static int prepareSingleStatement(sqlite3 *db, std::string const &query,
+                                  StatementCache *statementCache,
+                                  sqlite3_stmt **statement) {
+  const char *end = query.c_str() + query.length();
+  const char *tail = NULL;
+  int statementStatus =
+      statementCache != nullptr
+          ? statementCache->prepare(db, query, statement, &tail)
+          : sqlite3_prepare_v2(db, query.c_str(), (int)query.length(),
+                               statement, &tail);
+
+  if (statementStatus == SQLITE_OK && *statement != NULL &&
+      !isEmptyTail(tail, end)) {
+    // Statements which do not cover the whole query are never cached
+    sqlite3_finalize(*statement);
+    *statement = NULL;
+  }
+  return statementStatus;
+}
+
+/**
+ * Binds and steps a prepared statement count times, resetting it in between.
+ * Hands the statement back to the cache or finalizes it afterwards.
+ */
+static SQLiteOPResult
+stepRepeated(sqlite3 *db, std::string const &query, sqlite3_stmt *statement,
+             size_t count,
+             std::function<void(sqlite3_stmt *, size_t)> const &bindRow,
+             StatementCache *statementCache,
+             std::vector<QuickStatementResult> *statementResults) {
+  int rowsAffected = 0;
+  SQLiteOPResult status = {.type = SQLiteOk};
+
+  for (size_t i = 0; i < count; i++) {
+    bindRow(statement, i);
+
+    QuickResultSet *results = nullptr;
+    if (statementResults != nullptr) {
+      statementResults->push_back(QuickStatementResult{
+          .results = make_shared<QuickResultSet>()});
+      results = statementResults->back().results.get();
+    }
+
+    int result;
+    do {
+      result = sqlite3_step(statement);
+      if (result == SQLITE_ROW && results != nullptr) {
+        sqliteReadRow(statement, results);
       }
-      isConsuming = false;
+    } while (result == SQLITE_ROW);
+
+    if (result != SQLITE_DONE) {
+      status = SQLiteOPResult{
+          .type = SQLiteError,
+          .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
+                          std::string(sqlite3_errmsg(db)),
+          .rowsAffected = 0,
+          .insertId = 0};
       break;
+    }
 
-    default:
-      isFailed = true;
-      isConsuming = false;
+    if (results != nullptr) {
+      if (results->rowCount == 0) {
+        sqliteReadColumns(statement, results);
+      }
+      statementResults->back().status =
+          SQLiteOPResult{.type = SQLiteOk,
+                         .rowsAffected = sqlite3_changes(db),
+                         .insertId = sqlite3_last_insert_rowid(db)};
     }
+
+    rowsAffected += sqlite3_changes(db);
+    sqlite3_reset(statement);
+    // Parameters which are not bound by the next row are NULL
+    sqlite3_clear_bindings(statement);
   }
 
-  sqlite3_finalize(statement);
+  if (status.type == SQLiteOk) {
+    status = SQLiteOPResult{.type = SQLiteOk,
+                            .rowsAffected = rowsAffected,
+                            .insertId = sqlite3_last_insert_rowid(db)};
+  }
+  if (statementCache != nullptr) {
+    statementCache->release(query, statement);
+  } else {
+    sqlite3_finalize(statement);
+  }
+  return status;
+}
 
-  if (isFailed) {
+SQLiteOPResult
+sqliteExecuteRepeatedWithDB(sqlite3 *db, std::string const &query,
+                            QuickParameters *paramSets, size_t count,
+                            StatementCache *statementCache,
+                            std::vector<QuickStatementResult> *statementResults) {
+  sqlite3_stmt *statement = NULL;
+  int statementStatus =
+      prepareSingleStatement(db, query, statementCache, &statement);
+
+  if (statementStatus != SQLITE_OK) {
     const char *message = sqlite3_errmsg(db);
     return SQLiteOPResult{
         .type = SQLiteError,
         .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
-                        std::string(message),
-        .rowsAffected = 0,
-        .insertId = 0};
+                        string(message),
+        .rowsAffected = 0};
   }
 
-  int changedRowCount = sqlite3_changes(db);
-  long long latestInsertRowId = sqlite3_last_insert_rowid(db);
-  return SQLiteOPResult{.type = SQLiteOk,
-                        .rowsAffected = changedRowCount,
-                        .insertId = static_cast<double>(latestInsertRowId)};
+  if (statement == NULL) {
+    // Execute queries with multiple statements as usual
+    int rowsAffected = 0;
+    for (size_t i = 0; i < count; i++) {
+      QuickParameters &params = paramSets[i];
+      shared_ptr<QuickResultSet> results;
+      if (statementResults != nullptr) {
+        results = make_shared<QuickResultSet>();
+      }
+      auto status = sqliteExecuteWithDB(db, query, &params, results.get(),
+                                        statementCache);
+      if (status.type == SQLiteError) {
+        return status;
+      }
+      if (statementResults != nullptr) {
+        statementResults->push_back(
+            QuickStatementResult{.status = status, .results = results});
+      }
+      rowsAffected += status.rowsAffected;
+    }
+    return SQLiteOPResult{.type = SQLiteOk,
+                          .rowsAffected = rowsAffected,
+                          .insertId = sqlite3_last_insert_rowid(db)};
+  }
+
+  return stepRepeated(
+      db, query, statement, count,
+      [paramSets, statementCache](sqlite3_stmt *statement, size_t i) {
+        bindStatement(statement, &paramSets[i], 0, statementCache);
+      },
+      statementCache, statementResults);
+}
+
+SQLiteOPResult sqliteExecuteRepeatedWithDB(
+    sqlite3 *db, std::string const &query, size_t count,
+    std::function<void(sqlite3_stmt *, size_t)> const &bindRow,
+    StatementCache *statementCache) {
+  sqlite3_stmt *statement = NULL;
+  int statementStatus =
+      prepareSingleStatement(db, query, statementCache, &statement);
+
+  if (statementStatus != SQLITE_OK) {
+    const char *message = sqlite3_errmsg(db);
+    return SQLiteOPResult{
+        .type = SQLiteError,
+        .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
+                        string(message),
+        .rowsAffected = 0};
+  }
+  if (statement == NULL) {
+    return SQLiteOPResult{
+        .type = SQLiteError,
+        .errorMessage = "[react-native-quick-sqlite] SQL execution error: "
+                        "query must consist of a single statement",
+        .rowsAffected = 0};
+  }
+
+  return stepRepeated(db, query, statement, count, bindRow, statementCache,
+                      nullptr);
+}
+
+SQLiteOPResult sqliteExecutePreparedWithDB(sqlite3 *db,
+                                           std::string const &query,
+                                           sqlite3_stmt *statement,
+                                           QuickParameters *params,
+                                           StatementCache *statementCache) {
+  return stepRepeated(
+      db, query, statement, 1,
+      [params, statementCache](sqlite3_stmt *statement, size_t) {
+        bindStatement(statement, params, 0, statementCache);
+      },
+      statementCache, nullptr);
+}
+
+SQLiteOPResult sqliteOpenCursor(sqlite3 *db, std::string const &query,
+                                QuickParameters *params,
+                                sqlite3_stmt **statement) {
+  // Cursor statements outlive a single execution, they are not cached
+  int statementStatus =
+      sqlite3_prepare_v2(db, query.c_str(), -1, statement, NULL);
+
+  if (statementStatus != SQLITE_OK) {
+    const char *message = sqlite3_errmsg(db);
+    return SQLiteOPResult{
+        .type = SQLiteError,
+        .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
+                        string(message),
+        .rowsAffected = 0};
+  }
+
+  bindStatement(*statement, params);
+  return SQLiteOPResult{.type = SQLiteOk, .rowsAffected = 0};
+}
+
+SQLiteOPResult sqliteFetchCursor(sqlite3 *db, sqlite3_stmt *statement,
+                                 size_t maxRows, QuickResultSet *results,
+                                 bool *done) {
+  *done = false;
+
+  while (results->rowCount < maxRows) {
+    int result = sqlite3_step(statement);
+
+    if (result == SQLITE_ROW) {
+      sqliteReadRow(statement, results);
+    } else if (result == SQLITE_DONE) {
+      if (results->rowCount == 0) {
+        sqliteReadColumns(statement, results);
+      }
+      *done = true;
+      break;
+    } else {
+      const char *message = sqlite3_errmsg(db);
+      return SQLiteOPResult{
+          .type = SQLiteError,
+          .errorMessage = "[react-native-quick-sqlite] SQL execution error: " +
+                          std::string(message),
+          .rowsAffected = 0};
+    }
+  }
+
+  return SQLiteOPResult{.type = SQLiteOk, .rowsAffected = 0};
 }
 
 SequelLiteralUpdateResult sqliteExecuteLiteralWithDB(sqlite3 *db,
                                                      string const &query) {
+  const char *end = query.c_str() + query.length();
+  const char *tail = NULL;
+
   // SQLite statements need to be compiled before executed
-  sqlite3_stmt *statement;
+  sqlite3_stmt *statement = NULL;
 
   // Compile and move result into statement memory spot
-  int statementStatus =
-      sqlite3_prepare_v2(db, query.c_str(), -1, &statement, NULL);
+  int statementStatus = sqlite3_prepare_v2(db, query.c_str(),
+                                           (int)query.length(), &statement,
+                                           &tail);
 
-  if (statementStatus !=
-      SQLITE_OK) // statemnet is correct, bind the passed parameters
-  {
+  if (statementStatus != SQLITE_OK) {
     const char *message = sqlite3_errmsg(db);
     return {SQLiteError,
             "[react-native-quick-sqlite] SQL execution error: " +
@@ -192,14 +535,21 @@ SequelLiteralUpdateResult sqliteExecuteLiteralWithDB(sqlite3 *db,
             0};
   }
 
+  // Internal statements are built from caller input in places, anything after
+  // the first statement is rejected instead of executed
+  if (statement == NULL || !isEmptyTail(tail, end)) {
+    sqlite3_finalize(statement);
+    return {SQLiteError,
+            "[react-native-quick-sqlite] SQL execution error: Expected a "
+            "single statement",
+            0};
+  }
+
   bool isConsuming = true;
   bool isFailed = false;
 
-  int result, i, count, column_type;
-  string column_name;
-
   while (isConsuming) {
-    result = sqlite3_step(statement);
+    int result = sqlite3_step(statement);
 
     switch (result) {
     case SQLITE_ROW:
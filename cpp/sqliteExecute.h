@@ -1,16 +1,110 @@
 #include "JSIHelper.h"
+#include "StatementCache.h"
 #include "sqlite3.h"
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
 
+/**
+ * Executes every statement in the query. Returns the status of the last
+ * statement and reads the rows of the last statement into results.
+ * Execution stops at the first failing statement, previous statements are not
+ * rolled back.
+ */
+SQLiteOPResult sqliteExecuteWithDB(sqlite3 *db, std::string const &query,
+                                   QuickParameters *params,
+                                   QuickResultSet *results,
+                                   StatementCache *statementCache = nullptr);
+
+/**
+ * Executes every statement in the query like sqliteExecuteWithDB, appending
+ * the status and rows of each statement to statementResults.
+ */
 SQLiteOPResult
-sqliteExecuteWithDB(sqlite3 *db, std::string const &query,
-                    std::vector<QuickValue> *params,
-                    std::vector<map<std::string, QuickValue>> *results,
-                    std::vector<QuickColumnMetadata> *metadata);
+sqliteExecuteAllWithDB(sqlite3 *db, std::string const &query,
+                       QuickParameters *params,
+                       std::vector<QuickStatementResult> *statementResults,
+                       StatementCache *statementCache = nullptr);
+
+/**
+ * Executes the query once for each of the count parameter sets, stopping at
+ * the first failing execution. Queries consisting of a single statement are prepared
+ * once and reset between executions. Returns the total number of changed rows
+ * in rowsAffected. If statementResults is given, the status and rows of every
+ * execution are appended to it, otherwise rows are discarded.
+ */
+SQLiteOPResult sqliteExecuteRepeatedWithDB(
+    sqlite3 *db, std::string const &query,
+    QuickParameters *paramSets, size_t count,
+    StatementCache *statementCache = nullptr,
+    std::vector<QuickStatementResult> *statementResults = nullptr);
+
+/**
+ * Executes a query consisting of a single statement count times, preparing it
+ * once. bindRow is called with the row index to bind the parameters of each
+ * execution. Returns the total number of changed rows in rowsAffected.
+ */
+SQLiteOPResult sqliteExecuteRepeatedWithDB(
+    sqlite3 *db, std::string const &query, size_t count,
+    std::function<void(sqlite3_stmt *, size_t)> const &bindRow,
+    StatementCache *statementCache = nullptr);
+
+/**
+ * Binds params to a statement which was prepared from query and executes it
+ * once, discarding its rows. Hands the statement back to the cache or
+ * finalizes it afterwards.
+ */
+SQLiteOPResult sqliteExecutePreparedWithDB(sqlite3 *db,
+                                           std::string const &query,
+                                           sqlite3_stmt *statement,
+                                           QuickParameters *params,
+                                           StatementCache *statementCache);
+
+/**
+ * Prepares and binds a statement which is stepped by sqliteFetchCursor. The
+ * caller owns the statement and needs to finalize it.
+ */
+SQLiteOPResult sqliteOpenCursor(sqlite3 *db, std::string const &query,
+                                QuickParameters *params,
+                                sqlite3_stmt **statement);
 
+/**
+ * Steps a cursor statement until maxRows rows have been read into results.
+ * done is set once the statement has no more rows.
+ */
+SQLiteOPResult sqliteFetchCursor(sqlite3 *db, sqlite3_stmt *statement,
+                                 size_t maxRows, QuickResultSet *results,
+                                 bool *done);
+
+/**
+ * Executes a query consisting of a single statement without parameters,
+ * discarding its rows. Queries with more than one statement fail without
+ * executing anything.
+ */
 SequelLiteralUpdateResult sqliteExecuteLiteralWithDB(sqlite3 *db,
                                                      std::string const &query);
 
-void bindStatement(sqlite3_stmt *statement, std::vector<QuickValue> *values);
\ No newline at end of file
+/**
+ * Binds a single value to the parameter at sqIndex
+ */
+void bindValue(sqlite3_stmt *statement, int sqIndex, QuickValue const &value);
+
+/**
+ * Binds positional values starting at offset, or named values by name, to the
+ * parameters of the statement. Parameter indexes are looked up through the
+ * cache if the statement is owned by it.
+ */
+void bindStatement(sqlite3_stmt *statement, QuickParameters *params,
+                   size_t offset = 0,
+                   StatementCache *statementCache = nullptr);
+
+/**
+ * Reads the column names and declared types of a statement
+ */
+void sqliteReadColumns(sqlite3_stmt *statement, QuickResultSet *results);
+
+/**
+ * Appends the current row of a stepped statement to the result set
+ */
+void sqliteReadRow(sqlite3_stmt *statement, QuickResultSet *results);
\ No newline at end of file
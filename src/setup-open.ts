@@ -1,12 +1,21 @@
 import {
+  BatchOptions,
+  BulkColumn,
   ConcurrentLockType,
   ContextLockID,
+  ExecuteOptions,
+  ExportOptions,
+  ImportOptions,
   ISQLite,
+  LazyQueryResult,
   LockContext,
   LockOptions,
+  NativeExecuteOptions,
   OpenOptions,
+  QueryParams,
   QueryResult,
   QuickSQLiteConnection,
+  RawQueryResult,
   SQLBatchTuple,
   TransactionContext,
   UpdateCallback
@@ -14,7 +23,7 @@ import {
 
 import { DBListenerManagerInternal } from './DBListenerManager';
 import { LockHooks } from './lock-hooks';
-import { enhanceQueryResult } from './utils';
+import { enhanceQueryResult, toNativeBulkColumn } from './utils';
 
 type LockCallbackRecord = {
   callback: (context: LockContext) => Promise<any>;
@@ -37,6 +46,8 @@ const getRequestId = () => {
 };
 
 const LockCallbacks: Record<ContextLockID, LockCallbackRecord> = {};
+// Execution options derived from the open options of each database
+const DBExecuteOptions: Record<string, NativeExecuteOptions> = {};
 let proxy: ISQLite;
 
 /**
@@ -49,6 +60,45 @@ function closeContextLock(dbName: string, id: ContextLockID) {
   proxy.releaseLock(dbName, id);
 }
 
+/**
+ * Executes a query in a lock context, forwarding aborts of the signal to the
+ * native execution
+ */
+async function executeInContext(
+  dbName: string,
+  lockId: ContextLockID,
+  sql: string,
+  args: QueryParams | undefined,
+  nativeOptions: NativeExecuteOptions,
+  options?: ExecuteOptions
+) {
+  const signal = options?.signal;
+  const cancellationId = signal ? getRequestId() : undefined;
+  const result = proxy.executeInContext(dbName, lockId, sql, args, {
+    ...DBExecuteOptions[dbName],
+    ...nativeOptions,
+    timeoutMs: options?.timeoutMs,
+    chunkRows: options?.chunkRows,
+    chunkBudgetMs: options?.chunkBudgetMs,
+    cancellationId
+  });
+  if (!signal) {
+    return result;
+  }
+
+  const abort = () => proxy.cancelExecution(cancellationId);
+  if (signal.aborted) {
+    abort();
+  } else {
+    signal.addEventListener('abort', abort);
+  }
+  try {
+    return await result;
+  } finally {
+    signal.removeEventListener('abort', abort);
+  }
+}
+
 /**
  * JS callback to trigger queued callbacks when a lock context is available.
  * Declared on the global scope so that C++ can call it.
@@ -66,13 +116,48 @@ global.onLockContextIsAvailable = async (dbName: string, lockId: ContextLockID)
       if (record?.timeout) {
         clearTimeout(record.timeout);
       }
+      const executeOptions = DBExecuteOptions[dbName];
       await record?.callback({
         // @ts-expect-error This is not part of the public interface, but is used internally
         _contextId: lockId,
-        execute: async (sql: string, args?: any[]) => {
-          const result = await proxy.executeInContext(dbName, lockId, sql, args);
+        execute: async (sql: string, args?: QueryParams, options?: ExecuteOptions) => {
+          const result = (await executeInContext(
+            dbName,
+            lockId,
+            sql,
+            args,
+            { rowFormat: options?.json ? 'json' : undefined },
+            options
+          )) as QueryResult;
           enhanceQueryResult(result);
           return result;
+        },
+        executeAll: async (sql: string, args?: QueryParams, options?: ExecuteOptions) => {
+          const results = (await executeInContext(
+            dbName,
+            lockId,
+            sql,
+            args,
+            { allResults: true, rowFormat: options?.json ? 'json' : undefined },
+            options
+          )) as QueryResult[];
+          results.forEach(enhanceQueryResult);
+          return results;
+        },
+        executeRaw: async (sql: string, args?: QueryParams, options?: ExecuteOptions) =>
+          executeInContext(dbName, lockId, sql, args, { rowFormat: 'array' }, options) as Promise<RawQueryResult>,
+        executeLazy: async (sql: string, args?: QueryParams, options?: ExecuteOptions) =>
+          executeInContext(dbName, lockId, sql, args, { rowFormat: 'lazy' }, options) as Promise<LazyQueryResult>,
+        openCursor: async (sql: string, args?: QueryParams) => {
+          const cursorId = await proxy.openCursor(dbName, lockId, sql, args);
+          return {
+            fetch: async (count: number) => {
+              const result = await proxy.fetchCursor(dbName, lockId, cursorId, count, executeOptions);
+              enhanceQueryResult(result);
+              return result;
+            },
+            close: () => proxy.closeCursor(dbName, lockId, cursorId)
+          };
         }
       });
     } catch (ex) {
@@ -93,7 +178,7 @@ export function setupOpen(QuickSQLite: ISQLite) {
   return {
     /**
      * Opens a SQLite DB connection.
-     * By default opens DB in WAL mode with 4 Read connections and a single
+     * By default opens DB in WAL mode with up to 4 Read connections and a single
      * write connection
      */
     open: (dbName: string, options: OpenOptions = {}): QuickSQLiteConnection => {
@@ -102,6 +187,7 @@ export function setupOpen(QuickSQLite: ISQLite) {
         ...options,
         numReadConnections: options?.numReadConnections ?? DEFAULT_READ_CONNECTIONS
       });
+      DBExecuteOptions[dbName] = { integerMode: options?.integerMode };
 
       const listenerManager = new DBListenerManagerInternal({ dbName });
 
@@ -149,7 +235,7 @@ export function setupOpen(QuickSQLite: ISQLite) {
 
           try {
             // throws if lock could not be requested
-            QuickSQLite.requestLock(dbName, id, type);
+            QuickSQLite.requestLock(dbName, id, type, options?.priority);
             const timeout = options?.timeoutMs;
             if (timeout) {
               record.timeout = setTimeout(() => {
@@ -202,13 +288,13 @@ export function setupOpen(QuickSQLite: ISQLite) {
 
         const wrapExecute =
           <T>(
-            method: (sql: string, params?: any[]) => Promise<QueryResult>
-          ): ((sql: string, params?: any[]) => Promise<QueryResult>) =>
-          async (sql: string, params?: any[]) => {
+            method: (sql: string, params?: QueryParams, options?: ExecuteOptions) => Promise<T>
+          ): ((sql: string, params?: QueryParams, options?: ExecuteOptions) => Promise<T>) =>
+          async (sql: string, params?: QueryParams, options?: ExecuteOptions) => {
             if (finalized) {
               throw new Error(`Cannot execute in transaction after it has been finalized with commit/rollback.`);
             }
-            return method(sql, params);
+            return method(sql, params, options);
           };
 
         try {
@@ -216,7 +302,10 @@ export function setupOpen(QuickSQLite: ISQLite) {
             ...context,
             commit,
             rollback,
-            execute: wrapExecute(context.execute)
+            execute: wrapExecute(context.execute),
+            executeAll: wrapExecute(context.executeAll),
+            executeRaw: wrapExecute(context.executeRaw),
+            executeLazy: wrapExecute(context.executeLazy)
           });
           switch (defaultFinalizer) {
             case TransactionFinalizer.COMMIT:
@@ -242,25 +331,57 @@ export function setupOpen(QuickSQLite: ISQLite) {
       return {
         close: () => {
           QuickSQLite.close(dbName);
+          delete DBExecuteOptions[dbName];
           // Close any pending listeners
           listenerManager.iterateListeners((l) => l.closed?.());
         },
         refreshSchema: () => QuickSQLite.refreshSchema(dbName),
-        execute: (sql: string, args?: any[]) => writeLock((context) => context.execute(sql, args)),
+        getStatementCacheStats: () => QuickSQLite.getStatementCacheStats(dbName),
+        execute: (sql: string, args?: QueryParams, options?: ExecuteOptions) =>
+          writeLock((context) => context.execute(sql, args, options)),
+        executeAll: (sql: string, args?: QueryParams, options?: ExecuteOptions) =>
+          writeLock((context) => context.executeAll(sql, args, options)),
+        executeRaw: (sql: string, args?: QueryParams, options?: ExecuteOptions) =>
+          writeLock((context) => context.executeRaw(sql, args, options)),
+        executeLazy: (sql: string, args?: QueryParams, options?: ExecuteOptions) =>
+          writeLock((context) => context.executeLazy(sql, args, options)),
         readLock,
         readTransaction: async <T>(callback: (context: TransactionContext) => Promise<T>, options?: LockOptions) =>
-          readLock((context) => wrapTransaction(context, callback)),
+          readLock((context) => wrapTransaction(context, callback), options),
         writeLock,
         writeTransaction: async <T>(callback: (context: TransactionContext) => Promise<T>, options?: LockOptions) =>
           writeLock((context) => wrapTransaction(context, callback, TransactionFinalizer.COMMIT), options),
         delete: () => QuickSQLite.delete(dbName, options?.location),
-        executeBatch: (commands: SQLBatchTuple[]) =>
-          writeLock((context) => QuickSQLite.executeBatch(dbName, commands, (context as any)._contextId)),
+        executeBatch: (commands: SQLBatchTuple[], batchOptions?: BatchOptions) =>
+          writeLock(async (context) => {
+            const result = await QuickSQLite.executeBatch(dbName, commands, (context as any)._contextId, {
+              ...DBExecuteOptions[dbName],
+              allResults: batchOptions?.results,
+              continueOnError: batchOptions?.continueOnError,
+              commitEvery: batchOptions?.commitEvery,
+              checkpoint: batchOptions?.checkpoint,
+              onProgress: batchOptions?.onProgress
+            });
+            result.results?.forEach(enhanceQueryResult);
+            return result;
+          }),
+        executeBulk: (sql: string, columns: BulkColumn[]) =>
+          writeLock((context) =>
+            QuickSQLite.executeBulk(dbName, sql, columns.map(toNativeBulkColumn), (context as any)._contextId)
+          ),
         attach: (dbNameToAttach: string, alias: string, location?: string) =>
           QuickSQLite.attach(dbName, dbNameToAttach, alias, location),
         detach: (alias: string) => QuickSQLite.detach(dbName, alias),
         loadFile: (location: string) =>
           writeLock((context) => QuickSQLite.loadFile(dbName, location, (context as any)._contextId)),
+        importData: (location: string, table: string, options?: ImportOptions) =>
+          writeLock((context) =>
+            QuickSQLite.importData(dbName, location, table, options, (context as any)._contextId)
+          ),
+        exportData: (location: string, sql: string, args?: QueryParams, options?: ExportOptions) =>
+          readLock((context) =>
+            QuickSQLite.exportData(dbName, sql, args, location, options, (context as any)._contextId)
+          ),
         listenerManager,
         registerUpdateHook: (callback: UpdateCallback) =>
           listenerManager.registerListener({ rawTableChange: callback }),
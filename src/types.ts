@@ -11,7 +11,8 @@ import { DBListenerManager } from './DBListenerManager';
  * @interface QueryResult
  */
 export type QueryResult = {
-  insertId?: number;
+  /** A BigInt when the connection was opened with integerMode 'bigint' */
+  insertId?: number | bigint;
   rowsAffected: number;
   rows?: {
     /** Raw array with all dataset */
@@ -28,8 +29,98 @@ export type QueryResult = {
    * Query metadata, avaliable only for select query results
    */
   metadata?: ColumnMetadata[];
+  /** Number of JS thread tasks the rows were converted in, only set for `chunkRows` or `chunkBudgetMs` */
+  chunks?: number;
 };
 
+/**
+ * Result of a query where rows are returned as arrays of column values.
+ * Avoids creating an object with named properties for every row.
+ */
+export type RawQueryResult = {
+  insertId?: number | bigint;
+  rowsAffected: number;
+  /** The names of the result columns, in the order of the row values */
+  columnNames: string[];
+  /** One array of column values per row */
+  rows: any[][];
+  /** Number of JS thread tasks the rows were converted in, only set for `chunkRows` or `chunkBudgetMs` */
+  chunks?: number;
+};
+
+/**
+ * Rows of a lazy query result. Row objects are only created when a row is
+ * accessed, each access creates a new object. Unlike QueryResult rows there is
+ * no `_array` of all rows, converting them all would defeat the lazy format.
+ */
+export interface LazyRows {
+  readonly length: number;
+  readonly [index: number]: any;
+  item: (idx: number) => any;
+}
+
+/**
+ * Result of a query where rows are converted on access. The native result is
+ * kept in memory until the rows are garbage collected.
+ */
+export type LazyQueryResult = {
+  insertId?: number | bigint;
+  rowsAffected: number;
+  rows: LazyRows;
+  metadata?: ColumnMetadata[];
+};
+
+/**
+ * Options passed to native query executions
+ */
+export type NativeExecuteOptions = {
+  /**
+   * Returns rows as objects (default), as arrays of column values, as lazily converted objects or as objects parsed
+   * from natively serialized JSON
+   */
+  rowFormat?: 'object' | 'array' | 'lazy' | 'json';
+  /** Returns INTEGER values as JS numbers (default) or BigInt values */
+  integerMode?: IntegerMode;
+  /** Returns an array with the result of every statement instead of the last result */
+  allResults?: boolean;
+  /** Interrupts the execution after this many milliseconds */
+  timeoutMs?: number;
+  /** Identifies the execution for cancelExecution */
+  cancellationId?: string;
+  /** Maximum number of rows converted per JS thread task */
+  chunkRows?: number;
+  /** Maximum time in milliseconds spent converting rows per JS thread task */
+  chunkBudgetMs?: number;
+};
+
+/**
+ * Representation of INTEGER column values.
+ * 'number' loses precision for integers beyond Number.MAX_SAFE_INTEGER.
+ * 'bigint' returns every INTEGER value as a BigInt without loss of precision.
+ * It requires a JS runtime with BigInt support in JSI, open throws otherwise.
+ */
+export type IntegerMode = 'number' | 'bigint';
+
+/**
+ * A batch of rows fetched from a cursor
+ */
+export type CursorResult = QueryResult & {
+  /** Set once the cursor has no more rows, the cursor is closed automatically */
+  done: boolean;
+};
+
+/**
+ * Cursor over the rows of a query, opened in a lock context.
+ * The statement stays open on the connection between fetches.
+ * Cursors are closed automatically once all rows have been fetched or when
+ * the lock context is released.
+ */
+export interface QueryCursor {
+  /** Fetches up to the given number of rows */
+  fetch: (count: number) => Promise<CursorResult>;
+  close: () => Promise<void>;
+}
+
 /**
  * Column metadata
  * Describes some information about columns fetched by the query
@@ -44,13 +135,34 @@ export type ColumnMetadata = {
   columnIndex: number;
 };
 
+/**
+ * Query parameters. Arrays are bound by position, objects are bound by name.
+ * Object keys may include the :, @ or $ prefix of the parameter, keys without a
+ * prefix match any of them.
+ */
+export type QueryParams = any[] | Record<string, any>;
+
 /**
  * Allows the execution of bulk of sql commands
  * inside a transaction
  * If a single query must be executed many times with different arguments, its preferred
  * to declare it a single time, and use an array of array parameters.
  */
-export type SQLBatchTuple = [string] | [string, Array<any> | Array<Array<any>>];
+export type SQLBatchTuple = [string] | [string, QueryParams | Array<QueryParams>];
+
+/**
+ * Column of parameters for executeBulk, one value per row. Typed arrays are
+ * copied to native memory in one piece, plain arrays are converted value by
+ * value.
+ */
+export type BulkColumn = Int32Array | Float64Array | BigInt64Array | Array<any>;
+
+/**
+ * Bulk column as passed to the native module
+ */
+export type NativeBulkColumn =
+  | Array<any>
+  | { type: 'int32' | 'int64' | 'float64'; buffer: ArrayBufferLike; byteOffset: number; length: number };
 
 /**
  * status: 0 or undefined for correct execution, 1 for error
@@ -59,8 +171,54 @@ export type SQLBatchTuple = [string] | [string, Array<any> | Array<Array<any>>];
  */
 export type BatchQueryResult = {
   rowsAffected?: number;
+  /**
+   * The result of every command and parameter set in order, including insert
+   * IDs and rows returned by RETURNING clauses. Only set if requested with
+   * the `results` batch option.
+   */
+  results?: QueryResult[];
+  /**
+   * The commands which failed and were rolled back, only set if the batch was
+   * executed with the `continueOnError` option
+   */
+  errors?: BatchCommandError[];
 };
 
+/**
+ * A failed command of a batch. index counts every parameter set of every
+ * command, like the index of `BatchQueryResult.results`.
+ */
+export type BatchCommandError = {
+  index: number;
+  message: string;
+};
+
+/**
+ * Options for executeBatch
+ */
+export interface BatchOptions {
+  /** Collects the result of every command in `BatchQueryResult.results` */
+  results?: boolean;
+  /**
+   * Executes every command and parameter set in a savepoint. Failing commands
+   * are rolled back and reported in `BatchQueryResult.errors`, all other
+   * commands are committed.
+   */
+  continueOnError?: boolean;
+  /**
+   * Commits after every this many commands and parameter sets instead of
+   * committing the whole batch at once, which bounds the size of the WAL for
+   * large batches. A failing command only rolls back the commands since the
+   * last commit. The error the batch rejects with has a `committed` property
+   * with the number of committed commands and parameter sets.
+   */
+  commitEvery?: number;
+  /** Runs a passive WAL checkpoint after every intermediate commit */
+  checkpoint?: boolean;
+  /** Called with the number of committed and total commands after every commit */
+  onProgress?: (committed: number, total: number) => void;
+}
+
 /**
  * Result of loading a file and executing every line as a SQL command
  * Similar to BatchQueryResult
@@ -69,6 +227,60 @@ export interface FileLoadResult extends BatchQueryResult {
   commands?: number;
 }
 
+/**
+ * Options for importData
+ */
+export interface ImportOptions {
+  /** Defaults to 'csv'. The first CSV record names the fields. */
+  format?: 'csv' | 'ndjson';
+  /** Field delimiter of CSV files, defaults to ',' */
+  delimiter?: string;
+  /**
+   * Maps source fields to table columns. Defaults to importing every field of
+   * the CSV header or of the first NDJSON object into the column of the same name.
+   */
+  columns?: Record<string, string>;
+  /** Converts text values of the given table columns to numbers or numbers to text */
+  affinities?: Record<string, 'TEXT' | 'INTEGER' | 'REAL' | 'NUMERIC'>;
+  /** Rows per transaction, defaults to 10000 */
+  commitEvery?: number;
+  /** Called with the number of imported rows after every commit */
+  onProgress?: (rows: number) => void;
+}
+
+/**
+ * Result of importing a CSV or NDJSON file into a table
+ */
+export interface ImportResult {
+  rowsAffected?: number;
+  /** Number of imported records */
+  rows?: number;
+}
+
+/**
+ * Options for exportData
+ */
+export interface ExportOptions {
+  /** Defaults to 'csv'. CSV files start with a header record of the column names. */
+  format?: 'sql' | 'csv' | 'ndjson';
+  /** Field delimiter of CSV files, defaults to ',' */
+  delimiter?: string;
+  /** Table named in the INSERT statements, required for the 'sql' format */
+  table?: string;
+  /** Rows between progress reports, defaults to 10000 */
+  progressEvery?: number;
+  /** Called with the number of exported rows */
+  onProgress?: (rows: number) => void;
+}
+
+/**
+ * Result of exporting the rows of a query into a file
+ */
+export interface ExportResult {
+  /** Number of exported rows */
+  rows?: number;
+}
+
 export enum RowUpdateType {
   SQLITE_INSERT = 18,
   SQLITE_DELETE = 9,
@@ -106,16 +318,69 @@ export enum ConcurrentLockType {
   WRITE
 }
 
+/**
+ * Waiting lock requests are granted in order of priority. Requests which have
+ * been overtaken by higher priority requests a few times are granted next, so
+ * background work still progresses under load.
+ */
+export enum LockPriority {
+  /** Work a user is waiting for */
+  INTERACTIVE,
+  NORMAL,
+  /** Sync and maintenance work */
+  BACKGROUND
+}
+
 export type OpenOptions = {
   location?: string;
   /**
-   * The number of concurrent read connections to use.
+   * The maximum number of concurrent read connections to use.
    * Setting this value to zero will only open a single write connection.
-   * Setting this value > 0 will open the DB in WAL mode with [numReadConnections]
+   * Setting this value > 0 will open the DB in WAL mode with up to [numReadConnections]
    * read connections and a single write connection. This allows for concurrent
-   * read operations during a write operation.
+   * read operations during a write operation. Read connections are opened when
+   * a read lock is requested while all open read connections are in use.
    */
   numReadConnections?: number;
+  /**
+   * Read connections which have not been used for this long are closed, and
+   * reopened when needed. Reopening blocks the JS thread while the connection
+   * is opened. Set to zero to keep read connections open until the database is
+   * closed. Defaults to 30000.
+   */
+  readConnectionIdleTimeoutMs?: number;
+  /**
+   * The maximum number of prepared statements cached per connection.
+   * Statements are cached by SQL text, reusing them avoids parsing and
+   * planning frequently executed queries. Set to zero to disable caching.
+   * Defaults to 32.
+   */
+  statementCacheSize?: number;
+  /**
+   * Representation of INTEGER values in query results. Use 'bigint' for
+   * 64 bit identifiers which exceed Number.MAX_SAFE_INTEGER.
+   * BigInt query parameters are always bound as 64 bit integers.
+   * Opening with 'bigint' throws when the JS runtime has no BigInt support in JSI.
+   * Defaults to 'number'.
+   */
+  integerMode?: IntegerMode;
+};
+
+/**
+ * Prepared statement cache counters, aggregated for all connections of a database
+ */
+export type StatementCacheStats = {
+  /** Number of executions which reused a cached statement */
+  hits: number;
+  /**
+   * Number of executions which had to prepare a statement. Queries with
+   * several statements are never cached and are not counted.
+   */
+  misses: number;
+  /** Number of statements currently cached */
+  size: number;
+  /** Maximum number of statements which can be cached */
+  capacity: number;
 };
 
 export type Open = (dbName: string, options?: OpenOptions) => QuickSQLiteConnection;
@@ -125,24 +390,125 @@ export interface ISQLite {
   close: (dbName: string) => void;
   delete: (dbName: string, location?: string) => void;
   refreshSchema: (dbName: string) => Promise<void>;
+  getStatementCacheStats: (dbName: string) => StatementCacheStats;
 
-  requestLock: (dbName: string, id: ContextLockID, type: ConcurrentLockType) => QueryResult;
+  requestLock: (dbName: string, id: ContextLockID, type: ConcurrentLockType, priority?: LockPriority) => QueryResult;
   releaseLock(dbName: string, id: ContextLockID): void;
-  executeInContext: (dbName: string, id: ContextLockID, query: string, params: any[]) => Promise<QueryResult>;
+  executeInContext: (
+    dbName: string,
+    id: ContextLockID,
+    query: string,
+    params: QueryParams,
+    options?: NativeExecuteOptions
+  ) => Promise<QueryResult | RawQueryResult | LazyQueryResult | QueryResult[]>;
+  openCursor: (dbName: string, id: ContextLockID, query: string, params: QueryParams) => Promise<number>;
+  fetchCursor: (
+    dbName: string,
+    id: ContextLockID,
+    cursorId: number,
+    count: number,
+    options?: NativeExecuteOptions
+  ) => Promise<CursorResult>;
+  closeCursor: (dbName: string, id: ContextLockID, cursorId: number) => Promise<void>;
+  /** Interrupts an execution started with a cancellationId */
+  cancelExecution: (cancellationId: string) => void;
 
   attach: (mainDbName: string, dbNameToAttach: string, alias: string, location?: string) => void;
   detach: (mainDbName: string, alias: string) => void;
 
-  executeBatch: (dbName: string, commands: SQLBatchTuple[], id: ContextLockID) => Promise<BatchQueryResult>;
+  executeBatch: (
+    dbName: string,
+    commands: SQLBatchTuple[],
+    id: ContextLockID,
+    options?: NativeExecuteOptions & Omit<BatchOptions, 'results'>
+  ) => Promise<BatchQueryResult>;
+  executeBulk: (dbName: string, sql: string, columns: NativeBulkColumn[], id: ContextLockID) => Promise<BatchQueryResult>;
   loadFile: (dbName: string, location: string, id: ContextLockID) => Promise<FileLoadResult>;
+  importData: (
+    dbName: string,
+    location: string,
+    table: string,
+    options: ImportOptions | undefined,
+    id: ContextLockID
+  ) => Promise<ImportResult>;
+  exportData: (
+    dbName: string,
+    sql: string,
+    params: QueryParams | undefined,
+    location: string,
+    options: ExportOptions | undefined,
+    id: ContextLockID
+  ) => Promise<ExportResult>;
 }
 
 export interface LockOptions {
   timeoutMs?: number;
+  /** Defaults to `LockPriority.NORMAL` */
+  priority?: LockPriority;
+}
+
+/**
+ * Options for a single query execution
+ */
+export interface ExecuteOptions {
+  /**
+   * Interrupts the query if it runs for longer than this, measured from when
+   * it starts executing on its connection. The promise rejects with a
+   * `TimeoutError`.
+   */
+  timeoutMs?: number;
+  /**
+   * Interrupts the query once aborted. Queries which have not started yet are
+   * skipped. The promise rejects with an `AbortError`.
+   */
+  signal?: AbortSignal;
+  /**
+   * Converts the result rows in chunks of at most this many rows, yielding the
+   * JS thread in between chunks. Useful for large results which would otherwise
+   * block rendering while they are converted.
+   */
+  chunkRows?: number;
+  /**
+   * Yields the JS thread after converting result rows for this many
+   * milliseconds. Can be combined with `chunkRows`.
+   */
+  chunkBudgetMs?: number;
+  /**
+   * Serializes the rows to JSON natively and parses them with a single call,
+   * so conversion cost scales with the result size instead of the number of
+   * cells. INTEGER values are returned as numbers, BLOB values as null.
+   * With integerMode 'bigint', integers beyond Number.MAX_SAFE_INTEGER are
+   * returned as decimal strings, since JSON has no BigInt representation.
+   * Invalid UTF-8 in TEXT values is replaced with U+FFFD.
+   * Only applies to `execute` and `executeAll`.
+   */
+  json?: boolean;
 }
 
 export interface LockContext {
-  execute: (sql: string, args?: any[]) => Promise<QueryResult>;
+  /**
+   * Executes every statement in sql, returning the result of the last statement.
+   * Parameters are bound to the statements in order.
+   */
+  execute: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<QueryResult>;
+  /**
+   * Executes every statement in sql, returning one result per statement
+   */
+  executeAll: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<QueryResult[]>;
+  /**
+   * Executes a query, returning rows as arrays of column values
+   */
+  executeRaw: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<RawQueryResult>;
+  /**
+   * Executes a query, converting rows to objects only when they are accessed.
+   * Useful when only a part of a large result is read.
+   */
+  executeLazy: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<LazyQueryResult>;
+  /**
+   * Opens a cursor which fetches the rows of a query in batches.
+   * Keeps memory usage bounded for large result sets.
+   */
+  openCursor: (sql: string, args?: QueryParams) => Promise<QueryCursor>;
 }
 
 export interface TransactionContext extends LockContext {
@@ -153,7 +519,11 @@ export interface TransactionContext extends LockContext {
 export type QuickSQLiteConnection = {
   close: () => void;
   refreshSchema: () => Promise<void>;
-  execute: (sql: string, args?: any[]) => Promise<QueryResult>;
+  getStatementCacheStats: () => StatementCacheStats;
+  execute: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<QueryResult>;
+  executeAll: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<QueryResult[]>;
+  executeRaw: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<RawQueryResult>;
+  executeLazy: (sql: string, args?: QueryParams, options?: ExecuteOptions) => Promise<LazyQueryResult>;
   readLock: <T>(callback: (context: LockContext) => Promise<T>, options?: LockOptions) => Promise<T>;
   readTransaction: <T>(callback: (context: TransactionContext) => Promise<T>, options?: LockOptions) => Promise<T>;
   writeLock: <T>(callback: (context: LockContext) => Promise<T>, options?: LockOptions) => Promise<T>;
@@ -167,8 +537,27 @@ export type QuickSQLiteConnection = {
    * The detach method should only be called if there are no active locks/transactions.
    */
   detach: (alias: string) => void;
-  executeBatch: (commands: SQLBatchTuple[]) => Promise<BatchQueryResult>;
+  executeBatch: (commands: SQLBatchTuple[], options?: BatchOptions) => Promise<BatchQueryResult>;
+  /**
+   * Executes a single statement once per row in a transaction. Column i of the
+   * row is bound to parameter i + 1. All columns must have the same length.
+   */
+  executeBulk: (sql: string, columns: BulkColumn[]) => Promise<BatchQueryResult>;
   loadFile: (location: string) => Promise<FileLoadResult>;
+  /**
+   * Streams a CSV or NDJSON file into the table with a single prepared INSERT,
+   * committing every `commitEvery` rows. Empty unquoted CSV fields and missing
+   * NDJSON keys are imported as NULL. A failing row rolls back the rows since
+   * the last commit.
+   */
+  importData: (location: string, table: string, options?: ImportOptions) => Promise<ImportResult>;
+  /**
+   * Runs the query on a read connection and streams its rows into the file as
+   * INSERT statements, CSV or NDJSON. Rows are written as they are read, so the
+   * result set does not need to fit into memory. The file is replaced if it
+   * exists and removed if the export fails.
+   */
+  exportData: (location: string, sql: string, args?: QueryParams, options?: ExportOptions) => Promise<ExportResult>;
   /**
    * Register a callback which will be fired for each ROWID table change event.
    * Table changes are reported immediately.
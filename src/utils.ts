@@ -1,4 +1,4 @@
-import { QueryResult } from './types';
+import { BulkColumn, NativeBulkColumn, QueryResult } from './types';
 
 // Add 'item' function to result object to allow the sqlite-storage typeorm driver to work
 export const enhanceQueryResult = (result: QueryResult): void => {
@@ -13,3 +13,25 @@ export const enhanceQueryResult = (result: QueryResult): void => {
     result.rows.item = (idx: number) => result.rows._array[idx];
   }
 };
+
+// Describe typed arrays by their buffer so that they can be copied natively in one piece
+export const toNativeBulkColumn = (column: BulkColumn): NativeBulkColumn => {
+  if (Array.isArray(column)) {
+    return column;
+  }
+  let type: 'int32' | 'int64' | 'float64';
+  if (column instanceof Int32Array) {
+    type = 'int32';
+  } else if (column instanceof BigInt64Array) {
+    type = 'int64';
+  } else if (column instanceof Float64Array) {
+    type = 'float64';
+  } else {
+    // Other typed arrays would have their bytes reinterpreted natively
+    throw new TypeError(
+      'Bulk columns must be arrays, Int32Arrays, BigInt64Arrays or Float64Arrays, got ' +
+        Object.prototype.toString.call(column)
+    );
+  }
+  return { type, buffer: column.buffer, byteOffset: column.byteOffset, length: column.length };
+};
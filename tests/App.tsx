@@ -3,8 +3,11 @@ import React, { useEffect, useState } from 'react';
 import { SafeAreaView, ScrollView, Text } from 'react-native';
 import 'reflect-metadata';
 
-import { registerBaseTests, runTests } from './tests/index';
+import { registerBaseTests, registerBenchmarks, runTests } from './tests/index';
 const TEST_SERVER_URL = 'http://localhost:4243/results';
+// Benchmarks only report timings and slow down the test run.
+// Start the app with EXPO_PUBLIC_RUN_BENCHMARKS=true to include them.
+const RUN_BENCHMARKS = process.env.EXPO_PUBLIC_RUN_BENCHMARKS === 'true';
 
 export default function App() {
   const [results, setResults] = useState<any>([]);
@@ -13,7 +16,7 @@ export default function App() {
     setResults([]);
 
     try {
-      const results = await runTests(registerBaseTests);
+      const results = await runTests(registerBaseTests, ...(RUN_BENCHMARKS ? [registerBenchmarks] : []));
       console.log(JSON.stringify(results, null, '\t'));
       setResults(results);
       // Send results to host server
@@ -1,2 +1,3 @@
 export { runTests } from './mocha/MochaSetup';
 export { registerBaseTests } from './sqlite/rawQueries.spec';
+export { registerBenchmarks } from './sqlite/benchmarks.spec';
@@ -0,0 +1,190 @@
+import { open, QuickSQLiteConnection } from 'react-native-quick-sqlite';
+import { beforeAll, describe, it } from '../mocha/MochaRNAdapter';
+import { numberName } from './utils';
+
+const ROW_COUNT = 10_000;
+const ITERATIONS = 5;
+
+let db: QuickSQLiteConnection;
+let wideRows: any[][] = [];
+
+/**
+ * Returns the number of bytes allocated on the JS heap so far, or undefined if
+ * the runtime does not report it. Hermes counts all allocations, other runtimes
+ * only report the heap size, which shrinks when garbage is collected. Native
+ * allocations of the result sets are not included.
+ */
+function allocatedBytes(): number | undefined {
+  const stats = (global as any).HermesInternal?.getInstrumentedStats?.();
+  if (typeof stats?.js_totalAllocatedBytes == 'number') {
+    return stats.js_totalAllocatedBytes;
+  }
+  return (performance as any).memory?.usedJSHeapSize;
+}
+
+/**
+ * Runs the callback a few times and returns the average duration in
+ * milliseconds and the average JS heap allocations per row in bytes
+ */
+async function measure(rows: number, callback: () => Promise<unknown>) {
+  // Warm up caches before measuring
+  await callback();
+
+  const startBytes = allocatedBytes();
+  const start = performance.now();
+  for (let i = 0; i < ITERATIONS; i++) {
+    await callback();
+  }
+  const duration = (performance.now() - start) / ITERATIONS;
+  const endBytes = allocatedBytes();
+  const bytesPerRow =
+    startBytes != null && endBytes != null ? (endBytes - startBytes) / ITERATIONS / rows : undefined;
+  return { duration, bytesPerRow };
+}
+
+function report(name: string, { duration, bytesPerRow }: { duration: number; bytesPerRow?: number }) {
+  const allocations = bytesPerRow != null ? `, ${bytesPerRow.toFixed(0)} JS heap bytes allocated per row` : '';
+  console.log(`${name}: ${duration.toFixed(1)}ms${allocations}`);
+}
+
+/**
+ * Runs the callback and returns the longest time in milliseconds the JS thread
+ * was blocked meanwhile. Unless chunked, query results are converted in a
+ * single JS thread task, so this approximates the conversion time.
+ */
+async function measureBlocking(callback: () => Promise<unknown>) {
+  let longest = 0;
+  let last = performance.now();
+  let running = true;
+  const tick = () => {
+    const now = performance.now();
+    longest = Math.max(longest, now - last);
+    last = now;
+    if (running) {
+      setTimeout(tick, 1);
+    }
+  };
+  setTimeout(tick, 1);
+
+  await callback();
+  running = false;
+  return longest;
+}
+
+export function registerBenchmarks() {
+  describe('Benchmarks', () => {
+    beforeAll(async () => {
+      db?.close();
+      db = open('benchmarks');
+      await db.execute('DROP TABLE IF EXISTS narrow');
+      await db.execute('CREATE TABLE narrow(id INTEGER PRIMARY KEY, name TEXT)');
+      await db.execute('DROP TABLE IF EXISTS wide');
+      await db.execute(`
+        CREATE TABLE wide(
+          id INTEGER PRIMARY KEY, a INTEGER, b REAL, c TEXT, d TEXT, e INTEGER, f REAL, g TEXT, h TEXT
+        )`);
+
+      const narrowRows: any[][] = [];
+      wideRows = [];
+      for (let i = 0; i < ROW_COUNT; i++) {
+        const name = numberName(i % 10_000);
+        narrowRows.push([i, name]);
+        wideRows.push([i, i * 2, i / 3, name, `row ${i}`, -i, i * 1.5, name.toUpperCase(), null]);
+      }
+      await db.executeBatch([
+        ['INSERT INTO narrow(id, name) VALUES(?, ?)', narrowRows],
+        ['INSERT INTO wide(id, a, b, c, d, e, f, g, h) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)', wideRows]
+      ]);
+    });
+
+    it(`Read ${ROW_COUNT} narrow rows`, async () => {
+      const result = await measure(ROW_COUNT, () => db.readLock((tx) => tx.execute('SELECT * FROM narrow')));
+      report(`Read ${ROW_COUNT} narrow rows`, result);
+    });
+
+    it(`Read ${ROW_COUNT} wide rows`, async () => {
+      const result = await measure(ROW_COUNT, () => db.readLock((tx) => tx.execute('SELECT * FROM wide')));
+      report(`Read ${ROW_COUNT} wide rows`, result);
+    });
+
+    it(`Convert ${ROW_COUNT} wide rows on the JS thread`, async () => {
+      let blocked = 0;
+      for (let i = 0; i < ITERATIONS; i++) {
+        blocked += await measureBlocking(() => db.readLock((tx) => tx.execute('SELECT * FROM wide')));
+      }
+      report(`Convert ${ROW_COUNT} wide rows on the JS thread`, { duration: blocked / ITERATIONS });
+    });
+
+    it(`Convert ${ROW_COUNT} wide rows on the JS thread in chunks`, async () => {
+      let blocked = 0;
+      for (let i = 0; i < ITERATIONS; i++) {
+        blocked += await measureBlocking(() =>
+          db.readLock((tx) => tx.execute('SELECT * FROM wide', [], { chunkBudgetMs: 8 }))
+        );
+      }
+      const duration = blocked / ITERATIONS;
+      report(`Convert ${ROW_COUNT} wide rows on the JS thread in chunks`, { duration });
+    });
+
+    it(`Read the first row of ${ROW_COUNT} lazy wide rows`, async () => {
+      const result = await measure(ROW_COUNT, () =>
+        db.readLock(async (tx) => {
+          const lazy = await tx.executeLazy('SELECT * FROM wide');
+          return lazy.rows[0];
+        })
+      );
+      report(`Read the first row of ${ROW_COUNT} lazy wide rows`, result);
+    });
+
+    it(`Read ${ROW_COUNT} narrow rows as JSON`, async () => {
+      const result = await measure(ROW_COUNT, () =>
+        db.readLock((tx) => tx.execute('SELECT * FROM narrow', [], { json: true }))
+      );
+      report(`Read ${ROW_COUNT} narrow rows as JSON`, result);
+    });
+
+    it(`Read ${ROW_COUNT} wide rows as JSON`, async () => {
+      const result = await measure(ROW_COUNT, () =>
+        db.readLock((tx) => tx.execute('SELECT * FROM wide', [], { json: true }))
+      );
+      report(`Read ${ROW_COUNT} wide rows as JSON`, result);
+    });
+
+    it(`Read ${ROW_COUNT} wide rows as arrays`, async () => {
+      const result = await measure(ROW_COUNT, () => db.readLock((tx) => tx.executeRaw('SELECT * FROM wide')));
+      report(`Read ${ROW_COUNT} wide rows as arrays`, result);
+    });
+
+    it(`Insert ${ROW_COUNT} wide rows in a batch`, async () => {
+      await db.execute('CREATE TABLE IF NOT EXISTS wide_copy AS SELECT * FROM wide WHERE 0');
+      const result = await measure(ROW_COUNT, async () => {
+        await db.execute('DELETE FROM wide_copy');
+        await db.executeBatch([
+          ['INSERT INTO wide_copy(id, a, b, c, d, e, f, g, h) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)', wideRows]
+        ]);
+      });
+      report(`Insert ${ROW_COUNT} wide rows in a batch`, result);
+    });
+
+    it(`Insert ${ROW_COUNT} wide rows from columns`, async () => {
+      await db.execute('CREATE TABLE IF NOT EXISTS wide_copy AS SELECT * FROM wide WHERE 0');
+      const column = (index: number) => wideRows.map((row) => row[index]);
+      const columns = [
+        Int32Array.from(column(0)),
+        Int32Array.from(column(1)),
+        Float64Array.from(column(2)),
+        column(3),
+        column(4),
+        Int32Array.from(column(5)),
+        Float64Array.from(column(6)),
+        column(7),
+        column(8)
+      ];
+      const result = await measure(ROW_COUNT, async () => {
+        await db.execute('DELETE FROM wide_copy');
+        await db.executeBulk('INSERT INTO wide_copy(id, a, b, c, d, e, f, g, h) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)', columns);
+      });
+      report(`Insert ${ROW_COUNT} wide rows from columns`, result);
+    });
+  });
+}
@@ -1,8 +1,10 @@
 import { expect, use } from 'chai';
 import chaiAsPromised from 'chai-as-promised';
 import Chance from 'chance';
+import * as FileSystem from 'expo-file-system';
 import {
   BatchedUpdateNotification,
+  LockPriority,
   open,
   QueryResult,
   QuickSQLite,
@@ -37,6 +39,15 @@ function createTestUser(context: { execute: (sql: string, args?: any[]) => Promi
   return context.execute('INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [id, name, age, networth]);
 }
 
+/**
+ * Returns the URI of a file in the document directory and the path which the
+ * native functions expect
+ */
+function testFile(name: string) {
+  const uri = `${FileSystem.documentDirectory}${name}`;
+  return { uri, path: uri.replace(/^file:\/\//, '') };
+}
+
 /**
  * Creates read locks then queries the User table.
  * Returns an array of promises which resolve once each
@@ -148,6 +159,195 @@ export function registerBaseTests() {
       expect([...new Uint8Array(value)]).to.eql([18, 52]);
     });
 
+    it('reading multiple blobs', async () => {
+      const res = await db.execute("SELECT unhex('0102') AS r UNION ALL SELECT unhex('030405') AS r");
+      const [first, second] = res.rows._array.map((row) => row.r);
+
+      expect([...new Uint8Array(first)]).to.eql([1, 2]);
+      expect([...new Uint8Array(second)]).to.eql([3, 4, 5]);
+
+      // Each value is backed by its own bytes
+      new Uint8Array(first).fill(0);
+      expect([...new Uint8Array(second)]).to.eql([3, 4, 5]);
+    });
+
+    it('Query rows as arrays', async () => {
+      const { id, name, age, networth } = generateUserInfo();
+      await db.execute('INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [id, name, age, networth]);
+
+      const res = await db.executeRaw('SELECT id, name, age, networth FROM User WHERE id = ?', [id]);
+
+      expect(res.columnNames).to.eql(['id', 'name', 'age', 'networth']);
+      expect(res.rows).to.eql([[id, name, age, networth]]);
+    });
+
+    it('Should read and bind 64 bit integers as BigInt', async () => {
+      const bigintDb = open('test-bigint', { integerMode: 'bigint' });
+      try {
+        await bigintDb.execute('CREATE TABLE IF NOT EXISTS t1(id INTEGER PRIMARY KEY, c INTEGER)');
+        await bigintDb.execute('DELETE FROM t1');
+
+        const id = 9007199254740993n;
+        const res = await bigintDb.execute('INSERT INTO t1(id, c) VALUES(?, ?)', [id, -id]);
+        expect(res.insertId).to.equal(id);
+
+        const rows = await bigintDb.execute('SELECT id, c FROM t1 WHERE id = ?', [id]);
+        expect(rows.rows?._array).to.eql([{ id, c: -id }]);
+
+        // The default mode returns numbers
+        const numbers = await db.execute('SELECT 9007199254740993 AS value');
+        expect(typeof numbers.rows?.item(0).value).to.equal('number');
+      } finally {
+        bigintDb.close();
+        bigintDb.delete();
+      }
+    });
+
+    it('Should execute multiple statements', async () => {
+      const { id, name, age, networth } = generateUserInfo();
+      const res = await db.execute(
+        `INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?);
+         UPDATE User SET age = ? WHERE id = ?;
+         SELECT age FROM User WHERE id = ?`,
+        [id, name, age, networth, age + 1, id, id]
+      );
+      expect(res.rows?._array).to.eql([{ age: age + 1 }]);
+
+      const all = await db.executeAll('SELECT 1 AS a; SELECT 2 AS b');
+      expect(all.map((r) => r.rows?._array)).to.eql([[{ a: 1 }], [{ b: 2 }]]);
+    });
+
+    it('Should interrupt queries which exceed their timeout', async () => {
+      const endless = 'WITH RECURSIVE c(x) AS (SELECT 0 UNION ALL SELECT x + 1 FROM c) SELECT count(*) FROM c';
+      await expect(db.execute(endless, [], { timeoutMs: 50 })).to.be.rejectedWith(/timed out/);
+
+      // The connection is usable afterwards
+      const res = await db.execute('SELECT 1 AS one');
+      expect(res.rows?._array).to.eql([{ one: 1 }]);
+    });
+
+    it('Should cancel queries with an abort signal', async () => {
+      const endless = 'WITH RECURSIVE c(x) AS (SELECT 0 UNION ALL SELECT x + 1 FROM c) SELECT count(*) FROM c';
+      const controller = new AbortController();
+      const query = db.readLock((tx) => tx.execute(endless, [], { signal: controller.signal }));
+      setTimeout(() => controller.abort(), 50);
+
+      const error = await query.catch((e) => e);
+      expect(error.name).to.equal('AbortError');
+    });
+
+    it('Should bind named parameters', async () => {
+      const { id, name, age, networth } = generateUserInfo();
+      await db.execute('INSERT INTO User (id, name, age, networth) VALUES(:id, :name, @age, $networth)', {
+        id,
+        name,
+        age,
+        $networth: networth
+      });
+
+      const res = await db.execute('SELECT name, age FROM User WHERE id = :id', { id });
+      expect(res.rows?._array).to.eql([{ name, age }]);
+    });
+
+    it('Should convert results in chunks', async () => {
+      const sql = 'WITH RECURSIVE c(x) AS (SELECT 0 UNION ALL SELECT x + 1 FROM c WHERE x < 999) SELECT x FROM c';
+      const expected = Array.from({ length: 1000 }, (_, x) => ({ x }));
+
+      const byRows = await db.execute(sql, [], { chunkRows: 100 });
+      expect(byRows.rows?.length).to.equal(1000);
+      expect(byRows.rows?._array).to.eql(expected);
+      expect(byRows.chunks).to.equal(10);
+
+      const byTime = await db.execute(sql, [], { chunkBudgetMs: 1 });
+      expect(byTime.rows?._array).to.eql(expected);
+
+      const raw = await db.executeRaw(sql, [], { chunkRows: 64 });
+      expect(raw.rows.length).to.equal(1000);
+      expect(raw.rows[999]).to.eql([999]);
+      expect(raw.chunks).to.equal(16);
+
+      const unchunked = await db.execute(sql);
+      expect(unchunked.chunks).to.equal(undefined);
+    });
+
+    it('Should convert lazy rows when accessed', async () => {
+      const { id, name, age, networth } = generateUserInfo();
+      await db.execute('INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [id, name, age, networth]);
+
+      const res = await db.executeLazy('SELECT id, name, age, networth FROM User');
+      expect(res.rows.length).to.equal(1);
+      expect(res.rows[0]).to.eql({ id, name, age, networth });
+      expect(res.rows.item(0)).to.eql({ id, name, age, networth });
+      expect(res.rows[1]).to.equal(undefined);
+      expect(res.rows.item).to.equal(res.rows.item);
+      expect((res.rows as any)._array).to.equal(undefined);
+      expect(res.metadata?.map((column) => column.columnName)).to.eql(['id', 'name', 'age', 'networth']);
+
+      // Every access converts the row again, writes to a previous row must not show up
+      const blobs = await db.executeLazy('SELECT unhex(1234) AS r');
+      new Uint8Array(blobs.rows[0].r).fill(0);
+      expect([...new Uint8Array(blobs.rows[0].r)]).to.eql([18, 52]);
+      expect([...new Uint8Array(blobs.rows.item(0).r)]).to.eql([18, 52]);
+    });
+
+    it('Should return rows parsed from native JSON', async () => {
+      const { id, name, age, networth } = generateUserInfo();
+      await db.execute('INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [id, name, age, networth]);
+
+      const res = await db.execute('SELECT id, name, age, networth FROM User', [], { json: true });
+      expect(res.rows?._array).to.eql([{ id, name, age, networth }]);
+      expect(res.rows?.item(0)).to.eql({ id, name, age, networth });
+
+      const special = await db.execute(`SELECT 'a"b\\c' || char(10) AS text, 0.1 AS real, NULL AS empty`, [], {
+        json: true
+      });
+      expect(special.rows?._array).to.eql([{ text: 'a"b\\c\n', real: 0.1, empty: null }]);
+
+      // BLOBs have no JSON representation, invalid UTF-8 is replaced
+      const bytes = await db.execute(`SELECT x'00ff' AS blob, CAST(x'61ff62' AS TEXT) AS text`, [], { json: true });
+      expect(bytes.rows?._array).to.eql([{ blob: null, text: 'a\ufffdb' }]);
+
+      // Integers which would lose precision as numbers are returned as strings in BigInt mode
+      const bigintDb = open('test-bigint-json', { integerMode: 'bigint' });
+      try {
+        const integers = await bigintDb.execute('SELECT 9007199254740991 AS safe, 9007199254740993 AS unsafe', [], {
+          json: true
+        });
+        expect(integers.rows?._array).to.eql([{ safe: 9007199254740991, unsafe: '9007199254740993' }]);
+      } finally {
+        bigintDb.close();
+        bigintDb.delete();
+      }
+    });
+
+    it('Should reuse cached prepared statements', async () => {
+      await createTestUser();
+
+      const before = db.getStatementCacheStats();
+      await db.execute('SELECT * FROM User WHERE age > ?', [0]);
+      await db.execute('SELECT * FROM User WHERE age > ?', [1]);
+      const after = db.getStatementCacheStats();
+
+      expect(after.misses - before.misses).to.equal(1);
+      expect(after.hits - before.hits).to.equal(1);
+      expect(after.size).to.be.greaterThan(0);
+      expect(after.size).to.be.at.most(after.capacity);
+
+      // Queries with several statements are not cacheable and are no misses
+      await db.execute('SELECT 1; SELECT 2');
+      expect(db.getStatementCacheStats().misses).to.equal(after.misses);
+
+      // Cached statements should not survive schema changes
+      await db.refreshSchema();
+      expect(db.getStatementCacheStats().size).to.equal(0);
+    });
+
+    it('Should reject invalid statement cache sizes', () => {
+      expect(() => open('invalid_cache', { statementCacheSize: -1 })).to.throw(/statementCacheSize/);
+      expect(() => open('invalid_cache', { statementCacheSize: NaN })).to.throw(/statementCacheSize/);
+      expect(() => open('invalid_cache', { statementCacheSize: '8' as any })).to.throw(/statementCacheSize/);
+    });
+
     it('Failed insert', async () => {
       const id = chance.string(); // Setting the id to a string will throw an exception, it expects an int
       const { name, age, networth } = generateUserInfo();
@@ -383,6 +583,379 @@ export function registerBaseTests() {
       ]);
     });
 
+    it('Batch execute with repeated parameter sets', async () => {
+      const users = [1, 2, 3].map((id) => [id, `user${id}`, id * 10, id * 100]);
+      const result = await db.executeBatch([
+        ['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', users],
+        ['UPDATE User SET age = :age WHERE id = :id', [{ id: 1, age: 11 }, { id: 2 }]]
+      ]);
+      expect(result.rowsAffected).to.equal(5);
+
+      const res = await db.execute('SELECT id, age FROM User ORDER BY id');
+      // Named parameters missing from a parameter set are bound as NULL
+      expect(res.rows?._array).to.eql([
+        { id: 1, age: 11 },
+        { id: 2, age: null },
+        { id: 3, age: 30 }
+      ]);
+
+      await expect(
+        db.executeBatch([['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [[4, 'a', 1, 1], users[0]]]])
+      ).to.be.rejectedWith(/UNIQUE constraint failed/);
+      const count = await db.execute('SELECT count(*) AS count FROM User');
+      expect(count.rows?._array).to.eql([{ count: 3 }]);
+    });
+
+    it('Batch execute binding blobs', async () => {
+      const data = new Uint8Array([1, 2, 3]);
+      await db.execute('CREATE TABLE IF NOT EXISTS Blobs(data BLOB)');
+      await db.executeBatch([
+        ['INSERT INTO Blobs(data) VALUES (?)', [data.buffer]],
+        ['INSERT INTO Blobs(data) VALUES (?)', [[data.buffer], [new Uint8Array([4]).buffer]]]
+      ]);
+
+      const res = await db.execute('SELECT hex(data) AS data FROM Blobs');
+      expect(res.rows?._array).to.eql([{ data: '010203' }, { data: '010203' }, { data: '04' }]);
+    });
+
+    it('Batch execute with per-command results', async () => {
+      const result = await db.executeBatch(
+        [
+          ['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?) RETURNING name', [[7, 'a', 1, 1], [8, 'b', 2, 2]]],
+          ['UPDATE User SET age = age + 1']
+        ],
+        { results: true }
+      );
+
+      expect(result.rowsAffected).to.equal(4);
+      expect(result.results?.slice(0, 2).map((r) => r.insertId)).to.eql([7, 8]);
+      expect(result.results?.map((r) => r.rowsAffected)).to.eql([1, 1, 2]);
+      expect(result.results?.[1].rows?._array).to.eql([{ name: 'b' }]);
+      expect(result.results?.[1].rows?.item(0)).to.eql({ name: 'b' });
+
+      const plain = await db.executeBatch([['UPDATE User SET age = age + 1']]);
+      expect(plain.results).to.equal(undefined);
+    });
+
+    it('Batch execute continuing on errors', async () => {
+      const result = await db.executeBatch(
+        [
+          ['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [[1, 'a', 1, 1], [1, 'b', 2, 2], [2, 'c', 3, 3]]],
+          ['INSERT INTO tableThatDoesNotExist VALUES(1)']
+        ],
+        { continueOnError: true }
+      );
+
+      expect(result.rowsAffected).to.equal(2);
+      expect(result.errors?.map((e) => e.index)).to.eql([1, 3]);
+      expect(result.errors?.[0].message).to.include('UNIQUE constraint failed');
+      expect(result.errors?.[1].message).to.include('no such table');
+
+      const res = await db.execute('SELECT id, name FROM User ORDER BY id');
+      expect(res.rows?._array).to.eql([
+        { id: 1, name: 'a' },
+        { id: 2, name: 'c' }
+      ]);
+    });
+
+    it('Batch execute committing in chunks', async () => {
+      const users: any[][] = Array.from({ length: 10 }, (_, i) => [i + 1, `user${i + 1}`, i, i]);
+      const progress: number[][] = [];
+      const result = await db.executeBatch([['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', users]], {
+        commitEvery: 4,
+        checkpoint: true,
+        onProgress: (committed, total) => progress.push([committed, total])
+      });
+      expect(result.rowsAffected).to.equal(10);
+
+      // Progress callbacks are queued before the batch resolves
+      await new Promise((resolve) => setTimeout(resolve, 0));
+      expect(progress).to.eql([
+        [4, 10],
+        [8, 10],
+        [10, 10]
+      ]);
+
+      // Only the chunk containing the failing command is rolled back
+      const moreUsers = [...users.map(([id, ...rest]) => [id + 10, ...rest]), users[0]];
+      const error = await db
+        .executeBatch([['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', moreUsers]], {
+          commitEvery: 4
+        })
+        .then(
+          () => expect.fail('Should not resolve'),
+          (error) => error
+        );
+      expect(error.message).to.match(/UNIQUE constraint failed/);
+      expect(error.committed).to.equal(8);
+      const count = await db.execute('SELECT count(*) AS count FROM User');
+      expect(count.rows?._array).to.eql([{ count: 18 }]);
+    });
+
+    it('Bulk insert from typed array columns', async () => {
+      const result = await db.executeBulk('INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', [
+        new Int32Array([1, 2, 3]),
+        ['a', 'b', null],
+        new BigInt64Array([10n, 20n, 30n]).subarray(0, 3),
+        new Float64Array([1.5, NaN, 3.5])
+      ]);
+      expect(result.rowsAffected).to.equal(3);
+
+      const res = await db.execute('SELECT id, name, age, networth FROM User ORDER BY id');
+      expect(res.rows?._array).to.eql([
+        { id: 1, name: 'a', age: 10, networth: 1.5 },
+        { id: 2, name: 'b', age: 20, networth: null },
+        { id: 3, name: null, age: 30, networth: 3.5 }
+      ]);
+
+      await expect(db.executeBulk('INSERT INTO User (id) VALUES(?)', [new Int32Array([4, 4])])).to.be.rejectedWith(
+        /UNIQUE constraint failed/
+      );
+      await expect(
+        db.executeBulk('INSERT INTO User (id, name) VALUES(?, ?)', [new Int32Array([5]), []])
+      ).to.be.rejectedWith(/same length/);
+      // Only typed arrays with a native counterpart are accepted
+      await expect(
+        db.executeBulk('INSERT INTO User (id) VALUES(?)', [new Float32Array([6]) as any])
+      ).to.be.rejectedWith(TypeError);
+      const count = await db.execute('SELECT count(*) AS count FROM User');
+      expect(count.rows?._array).to.eql([{ count: 3 }]);
+    });
+
+    it('Should load SQL files split into statements', async () => {
+      const file = testFile('load.sql');
+      await FileSystem.writeAsStringAsync(
+        file.uri,
+        [
+          'CREATE TABLE Items(id INTEGER PRIMARY KEY, name TEXT);',
+          'CREATE TABLE Log(message TEXT);',
+          '-- a comment; with a semicolon',
+          'CREATE TRIGGER ItemsLog AFTER INSERT ON Items BEGIN',
+          "  INSERT INTO Log(message) VALUES ('added; ' || new.name);",
+          "  INSERT INTO Log(message) VALUES ('done');",
+          'END;',
+          'INSERT INTO Items(id, name)',
+          "  VALUES (1, 'semi;colon');",
+          "/* block; comment */ INSERT INTO Items(id, name) VALUES (2, 'it''s');",
+          // The last statement does not need a semicolon
+          "INSERT INTO Items(id, name) VALUES (3, 'last')"
+        ].join('\n')
+      );
+
+      const result = await db.loadFile(file.path);
+      expect(result.commands).to.equal(6);
+
+      const items = await db.execute('SELECT id, name FROM Items ORDER BY id');
+      expect(items.rows?._array).to.eql([
+        { id: 1, name: 'semi;colon' },
+        { id: 2, name: "it's" },
+        { id: 3, name: 'last' }
+      ]);
+      const log = await db.execute('SELECT message FROM Log ORDER BY rowid');
+      expect(log.rows?._array.map((row) => row.message)).to.eql([
+        'added; semi;colon',
+        'done',
+        "added; it's",
+        'done',
+        'added; last',
+        'done'
+      ]);
+
+      // Failing statements roll back the whole file
+      await FileSystem.writeAsStringAsync(
+        file.uri,
+        "INSERT INTO Items(id, name) VALUES (4, 'new');\nINSERT INTO Items(id, name) VALUES (1, 'duplicate');"
+      );
+      await expect(db.loadFile(file.path)).to.be.rejectedWith(/UNIQUE constraint failed/);
+      const count = await db.execute('SELECT count(*) AS count FROM Items');
+      expect(count.rows?._array).to.eql([{ count: 3 }]);
+    });
+
+    it('Should load integers beyond the 64 bit range from SQL files', async () => {
+      const file = testFile('limits.sql');
+      await FileSystem.writeAsStringAsync(
+        file.uri,
+        [
+          'CREATE TABLE Limits(id INTEGER PRIMARY KEY, value);',
+          'INSERT INTO Limits(id, value) VALUES (1, -9223372036854775808);',
+          'INSERT INTO Limits(id, value) VALUES (2, 9223372036854775808);',
+          'INSERT INTO Limits(id, value) VALUES (3, -5);'
+        ].join('\n')
+      );
+
+      await db.loadFile(file.path);
+      const res = await db.execute('SELECT typeof(value) AS type FROM Limits ORDER BY id');
+      expect(res.rows?._array.map((row) => row.type)).to.eql(['integer', 'real', 'integer']);
+      const min = await db.execute('SELECT CAST(value AS TEXT) AS text FROM Limits WHERE id = 1');
+      expect(min.rows?._array).to.eql([{ text: '-9223372036854775808' }]);
+    });
+
+    it('Should import exported CSV files', async () => {
+      await db.execute('CREATE TABLE Source(id INTEGER, name TEXT, note TEXT, score REAL)');
+      await db.execute('INSERT INTO Source VALUES (?, ?, ?, ?), (?, ?, ?, ?), (?, ?, ?, ?)', [
+        1,
+        'Smith, "J"',
+        'two\nlines',
+        1.5,
+        2,
+        '',
+        null,
+        null,
+        3,
+        null,
+        'x',
+        2
+      ]);
+      const file = testFile('roundtrip.csv');
+      const exported = await db.exportData(file.path, 'SELECT id, name, note, score FROM Source ORDER BY id');
+      expect(exported.rows).to.equal(3);
+
+      // Fields with delimiters, quotes and line breaks are quoted, NULL is an empty unquoted field
+      expect(await FileSystem.readAsStringAsync(file.uri)).to.equal(
+        'id,name,note,score\n1,"Smith, ""J""","two\nlines",1.5\n2,"",,\n3,,x,2.0\n'
+      );
+
+      await db.execute('CREATE TABLE Target(id, label, note, score)');
+      const progress: number[] = [];
+      const imported = await db.importData(file.path, 'Target', {
+        columns: { id: 'id', name: 'label', note: 'note', score: 'score' },
+        affinities: { id: 'INTEGER', score: 'REAL' },
+        commitEvery: 2,
+        onProgress: (rows) => progress.push(rows)
+      });
+      expect(imported.rows).to.equal(3);
+
+      // Progress callbacks are queued before the import resolves
+      await new Promise((resolve) => setTimeout(resolve, 0));
+      expect(progress).to.eql([2, 3]);
+
+      const res = await db.execute(
+        'SELECT id, typeof(id) AS idType, label, note, score, typeof(score) AS scoreType FROM Target ORDER BY id'
+      );
+      expect(res.rows?._array).to.eql([
+        { id: 1, idType: 'integer', label: 'Smith, "J"', note: 'two\nlines', score: 1.5, scoreType: 'real' },
+        { id: 2, idType: 'integer', label: '', note: null, score: null, scoreType: 'null' },
+        { id: 3, idType: 'integer', label: null, note: 'x', score: 2, scoreType: 'real' }
+      ]);
+    });
+
+    it('Should import NDJSON files', async () => {
+      const file = testFile('import.ndjson');
+      await FileSystem.writeAsStringAsync(
+        file.uri,
+        '{"id":1,"tags":["a","b"],"meta":{"x":1,"y":null}}\n{"id":2,"tags":[],"meta":"caf\\u00e9"}\n{"id":3}\n'
+      );
+      await db.execute('CREATE TABLE Docs(id INTEGER PRIMARY KEY, tags TEXT, meta TEXT)');
+
+      const imported = await db.importData(file.path, 'Docs', {
+        format: 'ndjson',
+        columns: { id: 'id', tags: 'tags', meta: 'meta' }
+      });
+      expect(imported.rows).to.equal(3);
+
+      // Nested values are stored as JSON text, missing keys as NULL
+      const res = await db.execute('SELECT id, tags, meta FROM Docs ORDER BY id');
+      expect(res.rows?._array).to.eql([
+        { id: 1, tags: '["a","b"]', meta: '{"x":1,"y":null}' },
+        { id: 2, tags: '[]', meta: 'café' },
+        { id: 3, tags: null, meta: null }
+      ]);
+
+      // Rows committed before the malformed line stay in the table
+      await FileSystem.writeAsStringAsync(file.uri, '{"id":4}\n{"id":5}\n{"id":6,\n');
+      await expect(
+        db.importData(file.path, 'Docs', { format: 'ndjson', columns: { id: 'id' }, commitEvery: 1 })
+      ).to.be.rejectedWith(/on line 3/);
+      const count = await db.execute('SELECT count(*) AS count FROM Docs');
+      expect(count.rows?._array).to.eql([{ count: 5 }]);
+    });
+
+    it('Should export query results to NDJSON and SQL files', async () => {
+      await db.execute('CREATE TABLE Docs(id INTEGER PRIMARY KEY, tags TEXT, meta TEXT)');
+      await db.execute('INSERT INTO Docs VALUES (?, ?, ?), (?, ?, ?), (?, ?, ?)', [
+        1,
+        '["a","b"]',
+        '{"x":1,"y":null}',
+        2,
+        '[]',
+        'café',
+        3,
+        null,
+        null
+      ]);
+      const file = testFile('export.ndjson');
+      const progress: number[] = [];
+      const exported = await db.exportData(file.path, 'SELECT id, tags, meta FROM Docs WHERE id > ? ORDER BY id', [0], {
+        format: 'ndjson',
+        progressEvery: 2,
+        onProgress: (rows) => progress.push(rows)
+      });
+      expect(exported.rows).to.equal(3);
+      expect(await FileSystem.readAsStringAsync(file.uri)).to.equal(
+        '{"id":1,"tags":"[\\"a\\",\\"b\\"]","meta":"{\\"x\\":1,\\"y\\":null}"}\n' +
+          '{"id":2,"tags":"[]","meta":"café"}\n' +
+          '{"id":3,"tags":null,"meta":null}\n'
+      );
+      await new Promise((resolve) => setTimeout(resolve, 0));
+      expect(progress).to.eql([2, 3]);
+
+      // SQL exports can be loaded back into another table
+      const sqlFile = testFile('export.sql');
+      await db.exportData(sqlFile.path, 'SELECT * FROM Docs', [], { format: 'sql', table: 'DocsCopy' });
+      await db.execute('CREATE TABLE DocsCopy(id INTEGER PRIMARY KEY, tags TEXT, meta TEXT)');
+      await db.loadFile(sqlFile.path);
+      const res = await db.execute(
+        'SELECT count(*) AS count FROM Docs JOIN DocsCopy USING (id) WHERE Docs.tags IS DocsCopy.tags AND Docs.meta IS DocsCopy.meta'
+      );
+      expect(res.rows?._array).to.eql([{ count: 3 }]);
+    });
+
+    it('Should remove the file of a failing export', async () => {
+      await createTestUser();
+      const file = testFile('failing.csv');
+      await FileSystem.writeAsStringAsync(file.uri, 'previous contents');
+
+      // The overflow is only detected while stepping, after the header has been written
+      await expect(
+        db.exportData(file.path, 'SELECT abs(-9223372036854775807 - 1) AS value FROM User')
+      ).to.be.rejectedWith(/integer overflow/);
+      expect((await FileSystem.getInfoAsync(file.uri)).exists).to.equal(false);
+    });
+
+    it('Should fetch rows from a cursor in batches', async () => {
+      const ids = [1, 2, 3, 4, 5];
+      await db.executeBatch([
+        ['INSERT INTO User (id, name, age, networth) VALUES(?, ?, ?, ?)', ids.map((id) => [id, `user${id}`, id, 0])]
+      ]);
+
+      const batches = await db.readLock(async (context) => {
+        const cursor = await context.openCursor('SELECT id FROM User WHERE id > ? ORDER BY id', [0]);
+        const result: number[][] = [];
+        let batch = await cursor.fetch(2);
+        result.push(batch.rows?._array.map((r) => r.id));
+        while (!batch.done) {
+          batch = await cursor.fetch(2);
+          result.push(batch.rows?._array.map((r) => r.id));
+        }
+        return result;
+      });
+
+      expect(batches).to.eql([[1, 2], [3, 4], [5]]);
+    });
+
+    it('Should close cursors when the lock is released', async () => {
+      await createTestUser();
+
+      const cursor = await db.readLock(async (context) => context.openCursor('SELECT * FROM User'));
+
+      try {
+        await cursor.fetch(1);
+        expect.fail('Should not resolve');
+      } catch (ex) {
+        expect(ex.message).to.include('Context is no longer available');
+      }
+    });
+
     it('Read lock should be read only', async () => {
       const { id, name, age, networth } = generateUserInfo();
 
@@ -530,6 +1103,54 @@ export function registerBaseTests() {
       singleConnection.close();
     });
 
+    it('Should open read connections on demand and close idle ones', async () => {
+      const elastic = open('elastic_reads', { statementCacheSize: 8, readConnectionIdleTimeoutMs: 50 });
+      // Only the write connection is open before the first read lock
+      expect(elastic.getStatementCacheStats().capacity).to.equal(8);
+
+      await Promise.all([
+        elastic.readLock((context) => context.execute('SELECT 1')),
+        elastic.readLock((context) => context.execute('SELECT 1'))
+      ]);
+      // Both read locks were requested while no read connection was free
+      expect(elastic.getStatementCacheStats().capacity).to.equal(24);
+
+      await new Promise((resolve) => setTimeout(resolve, 200));
+      expect(elastic.getStatementCacheStats().capacity).to.equal(8);
+
+      const res = await elastic.readLock((context) => context.execute('SELECT 1 as one'));
+      expect(res.rows?._array[0].one).to.equal(1);
+
+      elastic.close();
+    });
+
+    it('Should grant waiting locks by priority', async () => {
+      const order: string[] = [];
+      let release: () => void = () => {};
+      let started: () => void = () => {};
+      const isHeld = new Promise<void>((resolve) => (started = resolve));
+      const held = db.writeLock(
+        () =>
+          new Promise<void>((resolve) => {
+            release = resolve;
+            started();
+          })
+      );
+      await isHeld;
+
+      const waiting = [
+        db.writeLock(async () => order.push('background'), { priority: LockPriority.BACKGROUND }),
+        db.writeLock(async () => order.push('normal')),
+        db.writeLock(async () => order.push('interactive'), { priority: LockPriority.INTERACTIVE })
+      ];
+
+      release();
+      await held;
+      await Promise.all(waiting);
+
+      expect(order).to.deep.equal(['interactive', 'normal', 'background']);
+    });
+
     it('should trigger write transaction commit hooks', async () => {
       const commitPromise = new Promise<void>((resolve) =>
         db.listenerManager.registerListener({
@@ -628,9 +1249,16 @@ export function registerBaseTests() {
       const result = await db.execute('SELECT * from another.Places');
 
       db.detach('another');
+
+      // Aliases are quoted identifiers and cannot end the ATTACH statement
+      await createTestUser();
+      db.attach('single_connection', 'x; DELETE FROM User');
+      db.detach('x; DELETE FROM User');
       QuickSQLite.delete('single_connection');
 
       expect(result.rows?.length).to.equal(1);
+      const users = await db.execute('SELECT count(*) AS count FROM User');
+      expect(users.rows?._array).to.eql([{ count: 1 }]);
     });
 
     it('10000 INSERTs', async () => {